@@ -0,0 +1,280 @@
+#include "global.h"
+
+// largest array container, 4096 values take as much room as a bitset
+const uint ARRAY_LIMIT = 4096;
+// page number the pages of delta runs are numbered from, below it every page
+// of the table fits and a page of rows times it still fits in 32 bits
+const uint DELTA_PAGE_BASE = 1 << 20;
+
+/**
+ * @brief Function that turns an array container into a bitset
+ *
+ * @param container
+ */
+void RoaringBitmap::toBitset(Container &container)
+{
+    container.bits.assign(1024, 0);
+    for (uint16_t low : container.array)
+        container.bits[low >> 6] |= 1ULL << (low & 63);
+    vector<uint16_t>().swap(container.array);
+}
+
+/**
+ * @brief Function that turns a bitset container back into an array
+ *
+ * @param container
+ */
+void RoaringBitmap::toArray(Container &container)
+{
+    container.array.clear();
+    for (int wordCounter = 0; wordCounter < 1024; wordCounter++)
+    {
+        uint64_t word = container.bits[wordCounter];
+        while (word)
+        {
+            container.array.push_back(wordCounter * 64 + __builtin_ctzll(word));
+            word &= word - 1;
+        }
+    }
+    vector<uint64_t>().swap(container.bits);
+}
+
+/**
+ * @brief Function that adds the values of other to container
+ *
+ * @param container
+ * @param other
+ */
+void RoaringBitmap::unite(Container &container, const Container &other)
+{
+    if (container.bits.empty() && other.bits.empty())
+    {
+        vector<uint16_t> merged;
+        merged.reserve(container.array.size() + other.array.size());
+        set_union(container.array.begin(), container.array.end(), other.array.begin(), other.array.end(), back_inserter(merged));
+        container.array.swap(merged);
+        container.cardinality = container.array.size();
+        if (container.cardinality > ARRAY_LIMIT)
+            toBitset(container);
+        return;
+    }
+    if (container.bits.empty())
+        toBitset(container);
+    if (other.bits.empty())
+        for (uint16_t low : other.array)
+            container.bits[low >> 6] |= 1ULL << (low & 63);
+    else
+        for (int wordCounter = 0; wordCounter < 1024; wordCounter++)
+            container.bits[wordCounter] |= other.bits[wordCounter];
+    container.cardinality = 0;
+    for (uint64_t word : container.bits)
+        container.cardinality += __builtin_popcountll(word);
+}
+
+void RoaringBitmap::add(uint value)
+{
+    uint16_t key = value >> 16, low = value & 0xFFFF;
+    int position = lower_bound(this->keys.begin(), this->keys.end(), key) - this->keys.begin();
+    if (position == this->keys.size() || this->keys[position] != key)
+    {
+        this->keys.insert(this->keys.begin() + position, key);
+        this->containers.insert(this->containers.begin() + position, Container());
+    }
+    Container &container = this->containers[position];
+    if (!container.bits.empty())
+    {
+        uint64_t bit = 1ULL << (low & 63);
+        if (!(container.bits[low >> 6] & bit))
+        {
+            container.bits[low >> 6] |= bit;
+            container.cardinality++;
+        }
+        return;
+    }
+    auto slot = lower_bound(container.array.begin(), container.array.end(), low);
+    if (slot != container.array.end() && *slot == low)
+        return;
+    container.array.insert(slot, low);
+    container.cardinality++;
+    if (container.cardinality > ARRAY_LIMIT)
+        toBitset(container);
+}
+
+bool RoaringBitmap::remove(uint value)
+{
+    uint16_t key = value >> 16, low = value & 0xFFFF;
+    int position = lower_bound(this->keys.begin(), this->keys.end(), key) - this->keys.begin();
+    if (position == this->keys.size() || this->keys[position] != key)
+        return false;
+    Container &container = this->containers[position];
+    if (!container.bits.empty())
+    {
+        uint64_t bit = 1ULL << (low & 63);
+        if (!(container.bits[low >> 6] & bit))
+            return false;
+        container.bits[low >> 6] &= ~bit;
+        if (--container.cardinality <= ARRAY_LIMIT)
+            toArray(container);
+    }
+    else
+    {
+        auto slot = lower_bound(container.array.begin(), container.array.end(), low);
+        if (slot == container.array.end() || *slot != low)
+            return false;
+        container.array.erase(slot);
+        container.cardinality--;
+    }
+    if (container.cardinality == 0)
+    {
+        this->keys.erase(this->keys.begin() + position);
+        this->containers.erase(this->containers.begin() + position);
+    }
+    return true;
+}
+
+bool RoaringBitmap::contains(uint value)
+{
+    uint16_t key = value >> 16, low = value & 0xFFFF;
+    int position = lower_bound(this->keys.begin(), this->keys.end(), key) - this->keys.begin();
+    if (position == this->keys.size() || this->keys[position] != key)
+        return false;
+    Container &container = this->containers[position];
+    if (!container.bits.empty())
+        return container.bits[low >> 6] >> (low & 63) & 1;
+    return binary_search(container.array.begin(), container.array.end(), low);
+}
+
+bool RoaringBitmap::empty()
+{
+    return this->keys.empty();
+}
+
+/**
+ * @brief Union, merging the two sorted lists of containers
+ *
+ * @param other
+ * @return RoaringBitmap&
+ */
+RoaringBitmap &RoaringBitmap::operator|=(const RoaringBitmap &other)
+{
+    vector<uint16_t> keys;
+    vector<Container> containers;
+    keys.reserve(this->keys.size() + other.keys.size());
+    containers.reserve(this->keys.size() + other.keys.size());
+    int i = 0, j = 0;
+    while (i < this->keys.size() || j < other.keys.size())
+    {
+        if (j == other.keys.size() || (i < this->keys.size() && this->keys[i] < other.keys[j]))
+        {
+            keys.push_back(this->keys[i]);
+            containers.push_back(move(this->containers[i++]));
+        }
+        else if (i == this->keys.size() || other.keys[j] < this->keys[i])
+        {
+            keys.push_back(other.keys[j]);
+            containers.push_back(other.containers[j++]);
+        }
+        else
+        {
+            keys.push_back(this->keys[i]);
+            containers.push_back(move(this->containers[i++]));
+            unite(containers.back(), other.containers[j++]);
+        }
+    }
+    this->keys.swap(keys);
+    this->containers.swap(containers);
+    return *this;
+}
+
+/**
+ * @brief Function that lists the values of the set in increasing order
+ *
+ * @return vector<uint>
+ */
+vector<uint> RoaringBitmap::values()
+{
+    vector<uint> values;
+    for (int position = 0; position < this->keys.size(); position++)
+    {
+        uint high = (uint)this->keys[position] << 16;
+        Container &container = this->containers[position];
+        if (container.bits.empty())
+        {
+            for (uint16_t low : container.array)
+                values.push_back(high | low);
+            continue;
+        }
+        for (int wordCounter = 0; wordCounter < 1024; wordCounter++)
+        {
+            uint64_t word = container.bits[wordCounter];
+            while (word)
+            {
+                values.push_back(high | (wordCounter * 64 + __builtin_ctzll(word)));
+                word &= word - 1;
+            }
+        }
+    }
+    return values;
+}
+
+bitmapIndex::bitmapIndex()
+{
+    logger.log("bitmapIndex::bitmapIndex");
+}
+
+/**
+ * @brief Construct a new, empty bitmap index
+ *
+ * @param rowsPerPage most rows a page of the table holds
+ */
+bitmapIndex::bitmapIndex(uint rowsPerPage)
+{
+    logger.log("bitmapIndex::bitmapIndex");
+    this->rowsPerPage = rowsPerPage;
+}
+
+/**
+ * @brief Function that numbers a row of the table in the bitmaps
+ *
+ * @param pagePtr
+ * @param rowPtr
+ * @return uint
+ */
+uint bitmapIndex::rowNumber(int pagePtr, int rowPtr)
+{
+    uint page = pagePtr < -1 ? DELTA_PAGE_BASE - pagePtr : pagePtr + 1;
+    return page * this->rowsPerPage + rowPtr;
+}
+
+void bitmapIndex::insertItem(int key, int pagePtr, int rowPtr)
+{
+    this->bitmaps[key].add(this->rowNumber(pagePtr, rowPtr));
+}
+
+bool bitmapIndex::deleteItem(int key, int pagePtr, int rowPtr)
+{
+    auto bitmap = this->bitmaps.find(key);
+    if (bitmap == this->bitmaps.end() || !bitmap->second.remove(this->rowNumber(pagePtr, rowPtr)))
+        return false;
+    if (bitmap->second.empty())
+        this->bitmaps.erase(bitmap);
+    return true;
+}
+
+/**
+ * @brief Function that turns a set of row numbers back into locations, in
+ * page order
+ *
+ * @param rows
+ * @return vector<pair<int,int>>
+ */
+vector<pair<int,int>> bitmapIndex::locate(RoaringBitmap &rows)
+{
+    vector<pair<int,int>> locations;
+    for (uint row : rows.values())
+    {
+        uint page = row / this->rowsPerPage;
+        locations.push_back({page >= DELTA_PAGE_BASE ? (int)DELTA_PAGE_BASE - (int)page : (int)page - 1, (int)(row % this->rowsPerPage)});
+    }
+    return locations;
+}
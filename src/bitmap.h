@@ -0,0 +1,55 @@
+
+/**
+ * @brief A RoaringBitmap is a compressed set of 32 bit integers. The values
+ * are split on their high 16 bits into containers. A container with few
+ * values keeps their low 16 bits as a sorted array; one with more than
+ * ARRAY_LIMIT of them switches to a plain bitset of 65536 bits. Sparse and
+ * dense sets both stay small, and a union runs container by container.
+ *
+ */
+class RoaringBitmap
+{
+    struct Container
+    {
+        vector<uint16_t> array;
+        vector<uint64_t> bits; // empty unless the container is a bitset
+        uint cardinality = 0;
+    };
+    vector<uint16_t> keys; // high 16 bits of every container, sorted
+    vector<Container> containers;
+
+    static void toBitset(Container &container);
+    static void toArray(Container &container);
+    static void unite(Container &container, const Container &other);
+
+public:
+    void add(uint value);
+    bool remove(uint value);
+    bool contains(uint value);
+    bool empty();
+    RoaringBitmap &operator|=(const RoaringBitmap &other);
+    vector<uint> values();
+};
+
+/**
+ * @brief The bitmapIndex is an index for columns with few distinct values. It
+ * keeps the RoaringBitmap of the rows holding every value of the column. A
+ * row is numbered (pagePtr + 1) * rowsPerPage + rowPtr, so the overflow page
+ * -1 fits and the numbers follow the order of the pages. The pages of the
+ * runs of a delta store, -2 and below, are numbered from DELTA_PAGE_BASE up.
+ *
+ */
+class bitmapIndex
+{
+    uint rowsPerPage = 1;
+    uint rowNumber(int pagePtr, int rowPtr);
+
+public:
+    map<int, RoaringBitmap> bitmaps;
+
+    bitmapIndex();
+    bitmapIndex(uint rowsPerPage);
+    void insertItem(int key, int pagePtr, int rowPtr);
+    bool deleteItem(int key, int pagePtr, int rowPtr);
+    vector<pair<int,int>> locate(RoaringBitmap &rows);
+};
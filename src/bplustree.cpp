@@ -1,768 +1,719 @@
 #include "global.h"
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
-int MAAX ;
+/**
+ * @brief Construct a new arena for the nodes of a tree of the given capacity
+ *
+ * @param capacity
+ */
+NodeArena::NodeArena(int capacity) {
+  this->capacity = capacity;
+  // room for capacity + 1 entries and capacity + 2 children, in whole
+  // cache lines of 16 ints
+  this->stride = (capacity + 2 + 15) / 16 * 16;
+}
+
+NodeArena::~NodeArena() {
+  for (int *chunk : chunks)
+    free(chunk);
+}
+
+/**
+ * @brief Function called to hand out the block of one node. A chunk of 64
+ * blocks is allocated when the free list runs dry.
+ *
+ * @return int*
+ */
+int *NodeArena::allocate() {
+  if (freeBlocks.empty()) {
+    int blockSize = 4 * stride;
+    int *chunk = (int *)aligned_alloc(64, 64 * blockSize * sizeof(int));
+    chunks.push_back(chunk);
+    for (int i = 63; i >= 0; i--)
+      freeBlocks.push_back(chunk + i * blockSize);
+  }
+  int *block = freeBlocks.back();
+  freeBlocks.pop_back();
+  return block;
+}
+
+/**
+ * @brief Function called to take back the block of a node
+ *
+ * @param block
+ */
+void NodeArena::release(int *block) {
+  freeBlocks.push_back(block);
+}
 
 Node::Node() {
-  key = new int[MAAX + 1];
-  pagePtr = new int[MAAX + 1];
-  rowPtr = new int[MAAX + 1];
-  ptr = new Node *[MAAX + 1];
+  id = -1;
+  IS_LEAF = true;
+  size = 0;
+  block = NULL;
+  key = pagePtr = rowPtr = ptr = NULL;
+}
+
+/**
+ * @brief Construct an empty node. The arrays hold one entry more than the
+ * capacity of the tree so that a node can overflow before it is split.
+ *
+ * @param id
+ * @param isLeaf
+ * @param arena arena of the tree the node belongs to
+ */
+Node::Node(int id, bool isLeaf, shared_ptr<NodeArena> arena) {
+  this->id = id;
+  IS_LEAF = isLeaf;
+  size = 0;
+  allocate(arena);
+}
+
+Node::Node(const Node &other) {
+  id = other.id;
+  IS_LEAF = other.IS_LEAF;
+  size = other.size;
+  block = NULL;
+  key = pagePtr = rowPtr = ptr = NULL;
+  if (other.block != NULL) {
+    allocate(other.arena);
+    memcpy(block, other.block, 4 * arena->stride * sizeof(int));
+  }
+}
+
+Node::Node(Node &&other) {
+  id = other.id;
+  IS_LEAF = other.IS_LEAF;
+  size = other.size;
+  arena = move(other.arena);
+  block = other.block;
+  key = other.key;
+  pagePtr = other.pagePtr;
+  rowPtr = other.rowPtr;
+  ptr = other.ptr;
+  other.block = NULL;
+}
+
+Node &Node::operator=(Node other) {
+  swap(id, other.id);
+  swap(IS_LEAF, other.IS_LEAF);
+  swap(size, other.size);
+  swap(arena, other.arena);
+  swap(block, other.block);
+  swap(key, other.key);
+  swap(pagePtr, other.pagePtr);
+  swap(rowPtr, other.rowPtr);
+  swap(ptr, other.ptr);
+  return *this;
+}
+
+Node::~Node() {
+  if (block != NULL)
+    arena->release(block);
+}
+
+/**
+ * @brief Function called to take the block of a node from the arena of its
+ * tree
+ *
+ * @param arena
+ */
+void Node::allocate(shared_ptr<NodeArena> arena) {
+  this->arena = arena;
+  int stride = arena->stride;
+  block = arena->allocate();
+  memset(block, 0, 3 * stride * sizeof(int));
+  key = block;
+  pagePtr = block + stride;
+  rowPtr = block + 2 * stride;
+  ptr = block + 3 * stride;
+  fill(ptr, ptr + stride, -1);
+}
+
+/**
+ * @brief Function called to find the position of a key in the node, the
+ * number of keys smaller than x. The keys are sorted, so this is counted 4
+ * keys at a time with SSE2 compares instead of a branch per key.
+ *
+ * @param x
+ * @return int
+ */
+int Node::lowerBound(int x) {
+  int count = 0;
+#ifdef __SSE2__
+  __m128i value = _mm_set1_epi32(x);
+  for (int i = 0; i < size; i += 4) {
+    __m128i keys = _mm_load_si128((const __m128i *)(key + i));
+    int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(value, keys)));
+    if (size - i < 4)
+      mask &= (1 << (size - i)) - 1;
+    count += __builtin_popcount(mask);
+    if (mask != 15)
+      break;
+  }
+#else
+  for (int i = 0; i < size; i++)
+    count += key[i] < x;
+#endif
+  return count;
+}
+
+/**
+ * @brief Function called to find the child to descend into for a key, the
+ * number of keys smaller than or equal to x.
+ *
+ * @param x
+ * @return int
+ */
+int Node::upperBound(int x) {
+  int count = 0;
+#ifdef __SSE2__
+  __m128i value = _mm_set1_epi32(x);
+  for (int i = 0; i < size; i += 4) {
+    __m128i keys = _mm_load_si128((const __m128i *)(key + i));
+    int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(keys, value))) ^ 15;
+    if (size - i < 4)
+      mask &= (1 << (size - i)) - 1;
+    count += __builtin_popcount(mask);
+    if (mask != 15)
+      break;
+  }
+#else
+  for (int i = 0; i < size; i++)
+    count += key[i] <= x;
+#endif
+  return count;
 }
 
 bplusTree::bplusTree() {
-  root = NULL;
+  root = -1;
+  MAX = 0;
+  nodeCount = 0;
 }
 
 bplusTree::bplusTree(string tableName, string fanOut, int rowCount, int indexedColumn) {
   this->MAX = stoi(fanOut);
-  MAAX = this->MAX;
   this->tableName = tableName;
-  root = NULL;
+  this->indexName = tableName + "_BTree" + to_string(indexedColumn);
+  this->arena = make_shared<NodeArena>(this->MAX);
+  root = -1;
+  nodeCount = 0;
+}
+
+/**
+ * @brief Function called to allocate the next node id of the index
+ *
+ * @param isLeaf
+ * @return Node
+ */
+Node bplusTree::newNode(bool isLeaf) {
+  return Node(nodeCount++, isLeaf, this->arena);
+}
+
+/**
+ * @brief Function called to read a node from its index page
+ *
+ * @param id
+ * @return Node
+ */
+Node bplusTree::readNode(int id) {
+  Page page = bufferManager.getIndexPage(this->indexName, id, 4 * this->MAX + 3);
+  vector<int> row = page.getRow(0);
+  Node nd(id, row[0], this->arena);
+  nd.size = row[1];
+  const int *slots = row.data() + 2;
+  memcpy(nd.key, slots, nd.size * sizeof(int));
+  memcpy(nd.pagePtr, slots + this->MAX, nd.size * sizeof(int));
+  memcpy(nd.rowPtr, slots + 2 * this->MAX, nd.size * sizeof(int));
+  memcpy(nd.ptr, slots + 3 * this->MAX, (nd.size + 1) * sizeof(int));
+  return nd;
+}
+
+/**
+ * @brief Function called to write a node back to its index page. A node page
+ * is a single row of 4 * MAX + 3 integers: IS_LEAF, size, then MAX slots each
+ * of keys, pagePtrs and rowPtrs and MAX + 1 slots of ptrs.
+ *
+ * @param nd
+ */
+void bplusTree::writeNode(Node &nd) {
+  vector<int> row(4 * this->MAX + 3, 0);
+  row[0] = nd.IS_LEAF;
+  row[1] = nd.size;
+  int *slots = row.data() + 2;
+  memcpy(slots, nd.key, nd.size * sizeof(int));
+  memcpy(slots + this->MAX, nd.pagePtr, nd.size * sizeof(int));
+  memcpy(slots + 2 * this->MAX, nd.rowPtr, nd.size * sizeof(int));
+  memcpy(slots + 3 * this->MAX, nd.ptr, (nd.size + 1) * sizeof(int));
+  bufferManager.writeIndexPage(this->indexName, nd.id, {row});
+}
+
+/**
+ * @brief Function called to find the leaf a key belongs to. A run of equal
+ * keys may span several leaves, so lookups descend to the leftmost leaf that
+ * can hold x and inserts to the rightmost one.
+ *
+ * @param x
+ * @param rightmost
+ * @param path if not NULL, collects the internal nodes on the way, as the id
+ * of the node and the position of the child taken
+ * @return leaf node
+ */
+Node bplusTree::findLeaf(int x, bool rightmost, vector<pair<int,int>> *path) {
+  Node cursor = readNode(root);
+  while (cursor.IS_LEAF == false) {
+    int i = rightmost ? cursor.upperBound(x) : cursor.lowerBound(x);
+    if (path != NULL)
+      path->push_back(make_pair(cursor.id, i));
+    cursor = readNode(cursor.ptr[i]);
+  }
+  return cursor;
+}
+
+/**
+ * @brief Function called to find the entry of one row, given its key and its
+ * location
+ *
+ * @param x
+ * @param pagePtr
+ * @param rowPtr
+ * @param cursor set to the leaf holding the entry
+ * @param pos set to the position of the entry in the leaf
+ * @return true if the entry exists
+ */
+bool bplusTree::findEntry(int x, int pagePtr, int rowPtr, Node &cursor, int &pos) {
+  if (root == -1)
+    return false;
+  cursor = findLeaf(x, false);
+  pos = cursor.lowerBound(x);
+  while (true) {
+    for (; pos < cursor.size; pos++) {
+      if (cursor.key[pos] != x)
+        return false;
+      if (cursor.pagePtr[pos] == pagePtr && cursor.rowPtr[pos] == rowPtr)
+        return true;
+    }
+    if (cursor.ptr[cursor.size] == -1)
+      return false;
+    cursor = readNode(cursor.ptr[cursor.size]);
+    pos = 0;
+  }
 }
 
 /**
  * @brief Function called to search a key
  *
- * @param x 
- * @return pagePtr, rowPtr 
+ * @param x
+ * @return pagePtr, rowPtr of the first row with key x
  */
- pair<int,int> bplusTree::search(int x) {
-  if (root == NULL) {
+pair<int,int> bplusTree::search(int x) {
+  if (root == -1) {
     cout << "Tree is empty\n";
-	return {-1,-1};
-  } else {
-    Node *cursor = root;
-    while (cursor->IS_LEAF == false) {
-      for (int i = 0; i < cursor->size; i++) {
-        if (x < cursor->key[i]) {
-          cursor = cursor->ptr[i];
-          break;
-        }
-        if (i == cursor->size - 1) {
-          cursor = cursor->ptr[i + 1];
-          break;
-        }
-      }
-    }
-    for (int i = 0; i < cursor->size; i++) {
-      if (cursor->key[i] == x) {
-        // cout << "Found\n";
-        return make_pair(cursor->pagePtr[i],cursor->rowPtr[i]);
-      }
+    return {-1,-1};
+  }
+  return searchFirst(x, x);
+}
+
+/**
+ * @brief Function called to find the first row whose key lies in a range
+ *
+ * @param low
+ * @param high
+ * @return pagePtr, rowPtr, {-1, -1} if no key is in [low, high]
+ */
+pair<int,int> bplusTree::searchFirst(int low, int high) {
+  if (root == -1)
+    return {-1,-1};
+  Node cursor = findLeaf(low, false);
+  int i = cursor.lowerBound(low);
+  // the first key at or above low may open one of the next leaves
+  while (i == cursor.size && cursor.ptr[cursor.size] != -1) {
+    cursor = readNode(cursor.ptr[cursor.size]);
+    i = cursor.lowerBound(low);
+  }
+  if (i == cursor.size || cursor.key[i] > high)
+    return {-1,-1};
+  return make_pair(cursor.pagePtr[i], cursor.rowPtr[i]);
+}
+
+/**
+ * @brief Function called to search a range of keys. Descends once to the leaf
+ * of the lower bound and then follows the sibling pointers of the leaf chain
+ * until a key passes the upper bound.
+ *
+ * @param low smallest key of the range
+ * @param high largest key of the range
+ * @return pagePtr, rowPtr of every row with a key in [low, high], in key order
+ */
+vector<pair<int,int>> bplusTree::searchRange(int low, int high) {
+  vector<pair<int,int>> locations;
+  if (root == -1)
+    return locations;
+  Node cursor = findLeaf(low, false);
+  while (true) {
+    for (int i = cursor.lowerBound(low); i < cursor.size; i++) {
+      if (cursor.key[i] > high)
+        return locations;
+      locations.push_back(make_pair(cursor.pagePtr[i], cursor.rowPtr[i]));
     }
-    // cout << "Not found\n";
-	return {-1,-1};
+    if (cursor.ptr[cursor.size] == -1)
+      return locations;
+    cursor = readNode(cursor.ptr[cursor.size]);
+  }
+}
+
+/**
+ * @brief Function called to read the keys of a range without the locations
+ * of their rows. Walks the leaf chain like searchRange.
+ *
+ * @param low smallest key of the range
+ * @param high largest key of the range
+ * @return the key of every row with a key in [low, high], in key order
+ */
+vector<int> bplusTree::searchKeys(int low, int high) {
+  vector<int> keys;
+  if (root == -1)
+    return keys;
+  Node cursor = findLeaf(low, false);
+  while (true) {
+    int i = cursor.lowerBound(low);
+    int end = cursor.upperBound(high);
+    keys.insert(keys.end(), cursor.key + i, cursor.key + max(i, end));
+    if (end < cursor.size || cursor.ptr[cursor.size] == -1)
+      return keys;
+    cursor = readNode(cursor.ptr[cursor.size]);
+  }
+}
+
+/**
+ * @brief Function called when a row moves to another slot of its page, to
+ * point its entry at the new slot.
+ *
+ * @param x
+ * @param pagePtr
+ * @param rowPtr where the row was
+ * @param newRowPtr where the row is now
+ */
+void bplusTree::relocate(int x, int pagePtr, int rowPtr, int newRowPtr) {
+  Node cursor;
+  int pos;
+  if (root != -1 && findEntry(x, pagePtr, rowPtr, cursor, pos)) {
+    cursor.rowPtr[pos] = newRowPtr;
+    writeNode(cursor);
   }
 }
 
 /**
- * @brief Function called to search and update
+ * @brief Function called to search and update. The entry of the row that
+ * was at rowPtr + 1 of pagePtr moves back to rowPtr.
  *
- * @param x 
+ * @param x
  * @param pagePtr
  * @param rowPtr
- * @return  
+ * @return
  */
 void bplusTree::searchAndUpdate(int x, int pagePtr, int rowPtr) {
-  if (root == NULL) {
+  if (root == -1) {
     cout << "Tree is empty\n";
-	return;
-  } else {
-    Node *cursor = root;
-    while (cursor->IS_LEAF == false) {
-      for (int i = 0; i < cursor->size; i++) {
-        if (x < cursor->key[i]) {
-          cursor = cursor->ptr[i];
-          break;
-        }
-        if (i == cursor->size - 1) {
-          cursor = cursor->ptr[i + 1];
-          break;
-        }
-      }
-    }
-    for (int i = 0; i < cursor->size; i++) {
-      if (cursor->key[i] == x) {
-        // cout << "Found\n";
-		if(cursor->pagePtr[i] == pagePtr && cursor->rowPtr[i] == rowPtr + 1){
-			// this one has moved backward in the page
-			cursor->rowPtr[i]--;
-		}
-        return;
-      }
-    }
-    cout << "Not found\n";
-	return;
-  }	
+    return;
+  }
+  Node cursor;
+  int pos;
+  if (findEntry(x, pagePtr, rowPtr + 1, cursor, pos)) {
+    cursor.rowPtr[pos]--;
+    writeNode(cursor);
+    return;
+  }
+  cout << "Not found\n";
 }
 
 /**
  * @brief Function called to insert into B+ Tree
- * @param x 
+ * @param x
  * @param pagePtr
  * @param rowPtr
- * @return  
+ * @return
  */
 void bplusTree::insert(int x, int pagePtr, int rowPtr) {
-  if (root == NULL) {
-    root = new Node;
-    root->key[0] = x;
-    root->rowPtr[0] = rowPtr;
-    root->pagePtr[0] = pagePtr;
-    root->IS_LEAF = true;
-    root->size = 1;
-  } else {
-    Node *cursor = root;
-    Node *parent;
-    while (cursor->IS_LEAF == false) {
-      parent = cursor;
-      for (int i = 0; i < cursor->size; i++) {
-        if (x < cursor->key[i]) {
-          cursor = cursor->ptr[i];
-          break;
-        }
-        if (i == cursor->size - 1) {
-          cursor = cursor->ptr[i + 1];
-          break;
-        }
-      }
-    }
-    if (cursor->size < this->MAX) {
-      int i = 0;
-	  // upper bound
-      while (x > cursor->key[i] && i < cursor->size)
-        i++;
-      for (int j = cursor->size; j > i; j--) {
-        cursor->key[j] = cursor->key[j - 1];
-        cursor->pagePtr[j] = cursor->pagePtr[j - 1];
-        cursor->rowPtr[j] = cursor->rowPtr[j - 1];
-      }
-      cursor->key[i] = x;
-    cursor->pagePtr[i] = pagePtr;
-    cursor->rowPtr[i] = rowPtr;
-
-      cursor->size++;
-      cursor->ptr[cursor->size] = cursor->ptr[cursor->size - 1];
-      cursor->ptr[cursor->size - 1] = NULL;
-    } else {
-      Node *newLeaf = new Node;
-      int virtualNode[this->MAX + 1];
-      int virtualPageNode[this->MAX + 1];
-      int virtualRowNode[this->MAX + 1];
-      for (int i = 0; i < this->MAX; i++) {
-        virtualNode[i] = cursor->key[i];
-        virtualPageNode[i] = cursor->pagePtr[i];
-        virtualRowNode[i] = cursor->rowPtr[i];
-      }
-      int i = 0, j;
-      while (x > virtualNode[i] && i < this->MAX)
-        i++;
-      for (int j = this->MAX + 1; j > i; j--) {
-        virtualNode[j] = virtualNode[j - 1];
-        virtualPageNode[j] = virtualPageNode[j - 1];
-        virtualRowNode[j] = virtualRowNode[j - 1];
-      }
-      virtualNode[i] = x;
-        virtualPageNode[i] = pagePtr;
-        virtualRowNode[i] = rowPtr;
-
-      newLeaf->IS_LEAF = true;
-      cursor->size = (this->MAX + 1) / 2;
-      newLeaf->size = this->MAX + 1 - (this->MAX + 1) / 2;
-      cursor->ptr[cursor->size] = newLeaf;
-      newLeaf->ptr[newLeaf->size] = cursor->ptr[this->MAX];
-      cursor->ptr[this->MAX] = NULL;
-      for (i = 0; i < cursor->size; i++) {
-        cursor->key[i] = virtualNode[i];
-        cursor->pagePtr[i] = virtualPageNode[i];
-        cursor->rowPtr[i] = virtualRowNode[i];
-      }
-      for (i = 0, j = cursor->size; i < newLeaf->size; i++, j++) {
-        newLeaf->key[i] = virtualNode[j];
-        newLeaf->pagePtr[i] = virtualPageNode[j];
-        newLeaf->rowPtr[i] = virtualRowNode[j];
-      }
-      if (cursor == root) {
-        Node *newRoot = new Node;
-        newRoot->key[0] = newLeaf->key[0];
-        newRoot->pagePtr[0] = newLeaf->pagePtr[0];
-        newRoot->rowPtr[0] = newLeaf->rowPtr[0];
-        newRoot->ptr[0] = cursor;
-        newRoot->ptr[1] = newLeaf;
-        newRoot->IS_LEAF = false;
-        newRoot->size = 1;
-        root = newRoot;
-      } else {
-        insertInternal(newLeaf->key[0], newLeaf->pagePtr[0], newLeaf->rowPtr[0], parent, newLeaf);
-      }
-    }
+  if (root == -1) {
+    Node leaf = newNode(true);
+    leaf.key[0] = x;
+    leaf.pagePtr[0] = pagePtr;
+    leaf.rowPtr[0] = rowPtr;
+    leaf.size = 1;
+    writeNode(leaf);
+    root = leaf.id;
+    return;
+  }
+  vector<pair<int,int>> path;
+  Node cursor = findLeaf(x, true, &path);
+  int next = cursor.ptr[cursor.size];
+  // a duplicate goes after the rows already indexed under x
+  int i = cursor.upperBound(x);
+  for (int j = cursor.size; j > i; j--) {
+    cursor.key[j] = cursor.key[j - 1];
+    cursor.pagePtr[j] = cursor.pagePtr[j - 1];
+    cursor.rowPtr[j] = cursor.rowPtr[j - 1];
+  }
+  cursor.key[i] = x;
+  cursor.pagePtr[i] = pagePtr;
+  cursor.rowPtr[i] = rowPtr;
+  cursor.size++;
+  cursor.ptr[cursor.size] = next;
+  if (cursor.size <= this->MAX) {
+    writeNode(cursor);
+    return;
+  }
+
+  // the leaf overflowed, move its upper half to a new leaf
+  Node sibling = newNode(true);
+  int leftSize = (this->MAX + 1) / 2;
+  sibling.size = cursor.size - leftSize;
+  for (int j = 0; j < sibling.size; j++) {
+    sibling.key[j] = cursor.key[leftSize + j];
+    sibling.pagePtr[j] = cursor.pagePtr[leftSize + j];
+    sibling.rowPtr[j] = cursor.rowPtr[leftSize + j];
+  }
+  sibling.ptr[sibling.size] = next;
+  cursor.size = leftSize;
+  cursor.ptr[cursor.size] = sibling.id;
+  writeNode(cursor);
+  writeNode(sibling);
+  insertInternal(sibling.key[0], sibling.id, path);
+}
+
+/**
+ * @brief Function called to insert a separator into the parent of a split
+ * node, splitting the parents up the path as needed. Equal separators are
+ * allowed, so the slot comes from the path rather than from the key.
+ * @param x separator key
+ * @param child id of the new node to the right of x
+ * @param path the internal nodes from the root to the split node, each with
+ * the position of the child taken
+ * @return
+ */
+void bplusTree::insertInternal(int x, int child, vector<pair<int,int>> &path) {
+  if (path.empty()) {
+    // the root split, grow the tree by one level
+    Node newRoot = newNode(false);
+    newRoot.key[0] = x;
+    newRoot.ptr[0] = root;
+    newRoot.ptr[1] = child;
+    newRoot.size = 1;
+    writeNode(newRoot);
+    root = newRoot.id;
+    return;
+  }
+  Node cursor = readNode(path.back().first);
+  int i = path.back().second;
+  path.pop_back();
+  for (int j = cursor.size; j > i; j--)
+    cursor.key[j] = cursor.key[j - 1];
+  for (int j = cursor.size + 1; j > i + 1; j--)
+    cursor.ptr[j] = cursor.ptr[j - 1];
+  cursor.key[i] = x;
+  cursor.ptr[i + 1] = child;
+  cursor.size++;
+  if (cursor.size <= this->MAX) {
+    writeNode(cursor);
+    return;
   }
+
+  // the node overflowed, its middle key moves up to the parent
+  Node sibling = newNode(false);
+  int leftSize = (this->MAX + 1) / 2;
+  int upKey = cursor.key[leftSize];
+  sibling.size = cursor.size - leftSize - 1;
+  for (int j = 0; j < sibling.size; j++)
+    sibling.key[j] = cursor.key[leftSize + 1 + j];
+  for (int j = 0; j <= sibling.size; j++)
+    sibling.ptr[j] = cursor.ptr[leftSize + 1 + j];
+  cursor.size = leftSize;
+  writeNode(cursor);
+  writeNode(sibling);
+  insertInternal(upKey, sibling.id, path);
 }
 
 /**
- * @brief Function called to insert internally into leaf into B+ Tree
- * @param x 
+ * @brief Function called to append a key while bulk loading. Keys must arrive
+ * in increasing order, as they do from the sorted pages of the table. They are
+ * packed into the rightmost leaf up to BTREE_FILL_FACTOR and a new leaf is
+ * chained on when it is full. bulkBuild finishes the tree.
+ *
+ * @param x
  * @param pagePtr
  * @param rowPtr
- * @param cursor
- * @param child
- * @return  
  */
-void bplusTree::insertInternal(int x, int pagePtr, int rowPtr, Node *cursor, Node *child) {
-  if (cursor->size < this->MAX) {
-    int i = 0;
-    while (x > cursor->key[i] && i < cursor->size)
-      i++;
-    for (int j = cursor->size; j > i; j--) {
-      cursor->key[j] = cursor->key[j - 1];
-      cursor->pagePtr[j] = cursor->pagePtr[j - 1];
-      cursor->rowPtr[j] = cursor->rowPtr[j - 1];
-    }
-    for (int j = cursor->size + 1; j > i + 1; j--) {
-      cursor->ptr[j] = cursor->ptr[j - 1];
-    }
-    cursor->key[i] = x;
-    cursor->pagePtr[i] = pagePtr;
-    cursor->rowPtr[i] = rowPtr;
-    cursor->size++;
-    cursor->ptr[i + 1] = child;
-  } else {
-    Node *newInternal = new Node;
-    int virtualKey[this->MAX + 1];
-    int virtualPageKey[this->MAX + 1];
-    int virtualRowKey[this->MAX + 1];
-    Node *virtualPtr[this->MAX + 2];
-    for (int i = 0; i < this->MAX; i++) {
-      virtualKey[i] = cursor->key[i];
-      virtualPageKey[i] = cursor->pagePtr[i];
-      virtualRowKey[i] = cursor->rowPtr[i];
-    }
-    for (int i = 0; i < this->MAX + 1; i++) {
-      virtualPtr[i] = cursor->ptr[i];
-    }
-    int i = 0, j;
-    while (x > virtualKey[i] && i < this->MAX)
-      i++;
-    for (int j = this->MAX + 1; j > i; j--) {
-      virtualKey[j] = virtualKey[j - 1];
-      virtualPageKey[j] = virtualPageKey[j - 1];
-      virtualRowKey[j] = virtualRowKey[j - 1];
-    }
-    virtualKey[i] = x;
-    virtualPageKey[i] = pagePtr;
-    virtualRowKey[i] = rowPtr;
-    for (int j = this->MAX + 2; j > i + 1; j--) {
-      virtualPtr[j] = virtualPtr[j - 1];
-    }
-    virtualPtr[i + 1] = child;
-    newInternal->IS_LEAF = false;
-    cursor->size = (this->MAX + 1) / 2;
-    newInternal->size = this->MAX - (this->MAX + 1) / 2;
-    for (i = 0, j = cursor->size + 1; i < newInternal->size; i++, j++) {
-      newInternal->key[i] = virtualKey[j];
-      newInternal->pagePtr[i] = virtualPageKey[j];
-      newInternal->rowPtr[i] = virtualRowKey[j];
-    }
-    for (i = 0, j = cursor->size + 1; i < newInternal->size + 1; i++, j++) {
-      newInternal->ptr[i] = virtualPtr[j];
-    }
-    if (cursor == root) {
-      Node *newRoot = new Node;
-      newRoot->key[0] = cursor->key[cursor->size];
-      newRoot->pagePtr[0] = cursor->pagePtr[cursor->size];
-      newRoot->rowPtr[0] = cursor->rowPtr[cursor->size];
-      newRoot->ptr[0] = cursor;
-      newRoot->ptr[1] = newInternal;
-      newRoot->IS_LEAF = false;
-      newRoot->size = 1;
-      root = newRoot;
-    } else {
-      insertInternal(cursor->key[cursor->size], cursor->pagePtr[cursor->size], cursor->rowPtr[cursor->size]  ,findParent(root, cursor), newInternal);
+void bplusTree::bulkInsert(int x, int pagePtr, int rowPtr) {
+  int leafFill = max(1, (int)(this->MAX * BTREE_FILL_FACTOR));
+  if (bulkLeaf.id == -1 || bulkLeaf.size == leafFill) {
+    Node leaf = newNode(true);
+    if (bulkLeaf.id != -1) {
+      // the last two leaves stay in memory until bulkBuild evens them out
+      bulkLeaf.ptr[bulkLeaf.size] = leaf.id;
+      if (bulkPrevious.id != -1)
+        bulkWriteLeaf(bulkPrevious);
+      bulkPrevious = bulkLeaf;
     }
+    bulkLeaf = leaf;
   }
+  bulkLeaf.key[bulkLeaf.size] = x;
+  bulkLeaf.pagePtr[bulkLeaf.size] = pagePtr;
+  bulkLeaf.rowPtr[bulkLeaf.size] = rowPtr;
+  bulkLeaf.size++;
+}
+
+/**
+ * @brief Function called to write a finished leaf while bulk loading and
+ * remember it for the level above
+ *
+ * @param nd
+ */
+void bplusTree::bulkWriteLeaf(Node &nd) {
+  writeNode(nd);
+  bulkLevel.push_back(make_pair(nd.id, nd.key[0]));
 }
 
 /**
- * @brief Function called to find parent of cursor B+ Tree
- * @param cursor
- * @param child
- * @return parent
+ * @brief Function called once all keys have been bulk inserted. Builds the
+ * internal levels bottom-up over the leaves, one level at a time, instead
+ * of splitting nodes on the way down as insert does.
+ *
  */
-Node *bplusTree::findParent(Node *cursor, Node *child) {
-  Node *parent;
-  if (cursor->IS_LEAF || (cursor->ptr[0])->IS_LEAF) {
-    return NULL;
+void bplusTree::bulkBuild() {
+  // even out the last two leaves so the right edge is not left underfull
+  if (bulkPrevious.id != -1) {
+    int move = (bulkPrevious.size - bulkLeaf.size) / 2;
+    if (move > 0) {
+      for (int i = bulkLeaf.size - 1; i >= 0; i--) {
+        bulkLeaf.key[i + move] = bulkLeaf.key[i];
+        bulkLeaf.pagePtr[i + move] = bulkLeaf.pagePtr[i];
+        bulkLeaf.rowPtr[i + move] = bulkLeaf.rowPtr[i];
+      }
+      for (int i = 0; i < move; i++) {
+        bulkLeaf.key[i] = bulkPrevious.key[bulkPrevious.size - move + i];
+        bulkLeaf.pagePtr[i] = bulkPrevious.pagePtr[bulkPrevious.size - move + i];
+        bulkLeaf.rowPtr[i] = bulkPrevious.rowPtr[bulkPrevious.size - move + i];
+      }
+      bulkPrevious.ptr[bulkPrevious.size] = -1;
+      bulkPrevious.size -= move;
+      bulkPrevious.ptr[bulkPrevious.size] = bulkLeaf.id;
+      bulkLeaf.ptr[bulkLeaf.size] = -1;
+      bulkLeaf.size += move;
+    }
+    bulkWriteLeaf(bulkPrevious);
   }
-  for (int i = 0; i < cursor->size + 1; i++) {
-    if (cursor->ptr[i] == child) {
-      parent = cursor;
-      return parent;
-    } else {
-      parent = findParent(cursor->ptr[i], child);
-      if (parent != NULL)
-        return parent;
+  if (bulkLeaf.id != -1)
+    bulkWriteLeaf(bulkLeaf);
+
+  vector<pair<int,int>> level = bulkLevel;
+  bulkLevel.clear();
+  bulkPrevious = Node();
+  bulkLeaf = Node();
+  if (level.empty()) {
+    root = -1;
+    return;
+  }
+
+  int nodeFill = max(3, (int)((this->MAX + 1) * BTREE_FILL_FACTOR));
+  while (level.size() > 1) {
+    // spread the children evenly so that no node is left with a single child
+    int nodeCount = (level.size() + nodeFill - 1) / nodeFill;
+    vector<pair<int,int>> parents;
+    int childCounter = 0;
+    for (int nodeCounter = 0; nodeCounter < nodeCount; nodeCounter++) {
+      int children = level.size() / nodeCount + (nodeCounter < level.size() % nodeCount);
+      Node parent = newNode(false);
+      parent.size = children - 1;
+      for (int i = 0; i < children; i++) {
+        parent.ptr[i] = level[childCounter + i].first;
+        if (i > 0)
+          parent.key[i - 1] = level[childCounter + i].second;
+      }
+      writeNode(parent);
+      parents.push_back(make_pair(parent.id, level[childCounter].second));
+      childCounter += children;
     }
+    level = parents;
   }
-  return parent;
+  root = level[0].first;
 }
 
 /**
  * @brief Function called to display subTree of the B+ Tree
- * @param cursor 
- * @return  
+ * @param nodeId
+ * @return
  */
-void bplusTree::display(Node *cursor) {
-  if (cursor != NULL) {
-    for (int i = 0; i < cursor->size; i++) {
-      cout << cursor->key[i] << " " << "{{" << cursor->pagePtr[i] << "}}((" <<  cursor->rowPtr[i] << "))" << endl;
-    }
-    cout << "\n";
-    if (cursor->IS_LEAF == true) {
-        cout << "I AM LEAF" << endl;
-    }
-    else{
-        cout << "I AM NOT A LEAF" << endl;
-    }
-    if (cursor->IS_LEAF != true) {
-      for (int i = 0; i < cursor->size + 1; i++) {
-        display(cursor->ptr[i]);
-      }
+void bplusTree::display(int nodeId) {
+  if (nodeId == -1)
+    return;
+  Node cursor = readNode(nodeId);
+  for (int i = 0; i < cursor.size; i++) {
+    cout << cursor.key[i] << " " << "{{" << cursor.pagePtr[i] << "}}((" <<  cursor.rowPtr[i] << "))" << endl;
+  }
+  cout << "\n";
+  if (cursor.IS_LEAF == true) {
+    cout << "I AM LEAF" << endl;
+  }
+  else {
+    cout << "I AM NOT A LEAF" << endl;
+    for (int i = 0; i < cursor.size + 1; i++) {
+      display(cursor.ptr[i]);
     }
   }
 }
 
-
-// Get the root
 /**
  * @brief Function called to get the root of B+ Tree
- * @return  root
+ * @return  id of the root node, -1 if the tree is empty
  */
-Node *bplusTree::getRoot() {
+int bplusTree::getRoot() {
   return root;
 }
 
 /**
- * @brief Function called to delete a key from B+ Tree
- * @param x 
- * @return  
+ * @brief Function called to delete the entry of one row from B+ Tree. The
+ * entry is removed from its leaf only; leaves are allowed to underflow and are
+ * not merged, the separators above stay valid bounds and a rebuild compacts
+ * the tree.
+ * @param x
+ * @param pagePtr
+ * @param rowPtr
+ * @return
  */
-void bplusTree::removeKey(int x) {
-	Node* root = getRoot();
-
-	// If tree is empty
-	if (root == NULL) {
-		cout << "B+ Tree is Empty" << endl;
-		return;
-	}
-
-	Node* cursor = root;
-	Node* parent;
-	int leftSibling, rightSibling;
-
-	// Going to the Leaf Node, Which may contain the *key*
-	// TO-DO : Use Binary Search to find the val
-	while (cursor->IS_LEAF != true) {
-		for (int i = 0; i < cursor->size; i++) {
-			parent = cursor;
-			leftSibling = i - 1;//left side of the parent node
-			rightSibling = i + 1;// right side of the parent node
-
-			if (x < cursor->key[i]) {
-				cursor = cursor->ptr[i];
-				break;
-			}
-			if (i == cursor->size - 1) {
-				leftSibling = i;
-				rightSibling = i + 2;// CHECK here , might need to make it negative
-				cursor = cursor->ptr[i+1];
-				break;
-			}
-		}
-	}
-
-	// Check if the value exists in this leaf node
-	int pos = 0;
-	bool found = false;
-	for (pos = 0; pos < cursor->size; pos++) {
-		if (cursor->key[pos] == x) {
-			found = true;
-			break;
-		}
-	}
-
-	int itr = 0;
-	// lower bound
-	while (x >= cursor->key[itr] && itr < cursor->size)
-        itr++;
-
-	// auto itr = lower_bound(cursor->keys.begin(), cursor->keys.end(), x);
-
-	if (itr == cursor->size) {
-		cout << "Key Not Found in the Tree" << endl;
-		return;
-	}
-	
-	// Shifting the keys and dataPtr for the leaf Node
-	for (int i = pos; i < cursor->size - 1; i++) {
-		cursor->key[i] = cursor->key[i+1];
-	}
-
-	int prev_size = cursor->size;
-	cursor->size = prev_size - 1;
-	// cursor->ptr2TreeOrData.dataPtr.resize(prev_size - 1);
-
-	// If it is leaf as well as the root node
-	if (cursor == root) {
-		if (cursor->size == 0) {
-			// Tree becomes empty
-			root = NULL;
-			cout << "Ohh!! Our Tree is Empty Now :(" << endl;
-		}
-	}
-	
-	cout << "Deleted " << x << " From Leaf Node successfully" << endl;
-	if (cursor->size >= (this->MAX + 1) / 2) {
-		//Sufficient Node available for invariant to hold
-		return;
-	}
-
-	cout << "UnderFlow in the leaf Node Happended" << endl;
-	cout << "Starting Redistribution..." << endl;
-
-	//1. Try to borrow a key from leftSibling
-	if (leftSibling >= 0) {
-		Node* leftNode = parent->ptr[leftSibling];
-
-		//Check if LeftSibling has extra Key to transfer
-		if (leftNode->size >= (this->MAX + 1) / 2 + 1) {
-
-			//Transfer the maximum key from the left Sibling
-			int maxIdx = leftNode->size - 1;
-
-			// insert at start
-			cursor->key[0] = leftNode->key[maxIdx];
-			for (int i = 1; i < cursor->size ; i++)
-			{
-				cursor->key[i] = cursor->key[i - 1];
-			}
-
-			cursor->ptr[0] = leftNode->ptr[maxIdx];
-			for (int i = 1; i < cursor->size ; i++)
-			{
-				cursor->ptr[i] = cursor->ptr[i - 1];
-			}
-
-			// cursor->keys.insert(cursor->keys.begin(), leftNode->keys[maxIdx]);
-			// cursor->ptr2TreeOrData.dataPtr
-				// .insert(cursor->ptr2TreeOrData.dataPtr.begin(), leftNode->ptr2TreeOrData.dataPtr[maxIdx]);
-
-			//resize the left Sibling Node After Tranfer
-			leftNode->size = maxIdx;
-			// leftNode->keys.resize(maxIdx);
-			// leftNode->ptr2TreeOrData.dataPtr.resize(maxIdx);
-
-			//Update Parent
-			parent->key[leftSibling] = cursor->key[0];
-			printf("Transferred from left sibling of leaf node\n");
-			return;
-		}
-	}
-
-	//2. Try to borrow a key from rightSibling
-	if (rightSibling < parent->size) {
-		Node* rightNode = parent->ptr[rightSibling];
-
-		//Check if RightSibling has extra Key to transfer
-		if (rightNode->size >= (this->MAX + 1) / 2 + 1) {
-
-			//Transfer the minimum key from the right Sibling
-			//Transfer the maximum key from the left Sibling
-			int minIdx = 0;
-
-			// insert at end
-			for (int i = 0; i < cursor->size - 1; i++)
-			{
-				cursor->key[i] = cursor->key[i + 1];
-			}
-			cursor->key[cursor->size - 1] = rightNode->key[minIdx];
-
-			for (int i = 0; i < cursor->size - 1; i++)
-			{
-				cursor->ptr[i] = cursor->ptr[i + 1];
-			}
-			cursor->ptr[cursor->size - 1] = rightNode->ptr[minIdx];
-
-
-			// cursor->keys.push_back(rightNode->keys[minIdx]);
-			// cursor->ptr2TreeOrData.dataPtr
-			// 	.push_back(rightNode->ptr2TreeOrData.dataPtr[minIdx]);
-
-			//resize the right Sibling Node After Tranfer
-			// rightNode->keys.erase(rightNode->keys.begin());
-			// rightNode->ptr2TreeOrData.dataPtr.erase(rightNode->ptr2TreeOrData.dataPtr.begin());
-
-			//Update Parent
-			parent->key[rightSibling-1] = rightNode->key[0];
-			printf("Transferred from right sibling of leaf node\n");
-			return;
-		}
-	}
-
-	// Merge and Delete Node
-	if (leftSibling >= 0) {// If left sibling exists
-		Node* leftNode = parent->ptr[leftSibling];
-		//Transfer Key and dataPtr to leftSibling and connect ptr2next
-		for (int i = 0; i < cursor->size; i++) {
-			leftNode->key[leftNode->size] = cursor->key[i];
-			leftNode->ptr[leftNode->size++] = cursor->ptr[i];
-			// leftNode->keys.push_back(cursor->keys[i]);
-			// leftNode->ptr2TreeOrData.dataPtr
-			// 	.push_back(cursor->ptr2TreeOrData.dataPtr[i]);
-		}
-		// leftNode->ptr2next = cursor->ptr2next;
-		cout << "Merging two leaf Nodes" << endl;
-		// removeInternal(parent->keys[leftSibling], parent, cursor);//delete parent Node Key
-		//delete cursor;
-	}
-	else if (rightSibling <= parent->size) {
-		Node* rightNode = parent->ptr[rightSibling];
-		//Transfer Key and dataPtr to rightSibling and connect ptr2next
-		for (int i = 0; i < rightNode->size; i++) {
-			cursor->key[cursor->size] = rightNode->key[i];
-			cursor->ptr[cursor->size++] = rightNode->ptr[i];
-			// cursor->keys.push_back(rightNode->keys[i]);
-			// cursor->ptr2TreeOrData.dataPtr
-			// 	.push_back(rightNode->ptr2TreeOrData.dataPtr[i]);
-		}
-		// cursor->ptr2next = rightNode->ptr2next;
-		cout << "Merging two leaf Nodes" << endl;
-		// removeInternal(parent->keys[rightSibling-1], parent, rightNode);//delete parent Node Key
-		//delete rightNode;
-	}
-
+void bplusTree::removeKey(int x, int pagePtr, int rowPtr) {
+  if (root == -1) {
+    cout << "B+ Tree is Empty" << endl;
+    return;
+  }
+  Node cursor;
+  int pos;
+  if (!findEntry(x, pagePtr, rowPtr, cursor, pos)) {
+    cout << "Key Not Found in the Tree" << endl;
+    return;
+  }
+  int next = cursor.ptr[cursor.size];
+  for (int i = pos; i < cursor.size - 1; i++) {
+    cursor.key[i] = cursor.key[i + 1];
+    cursor.pagePtr[i] = cursor.pagePtr[i + 1];
+    cursor.rowPtr[i] = cursor.rowPtr[i + 1];
+  }
+  cursor.size--;
+  cursor.ptr[cursor.size] = next;
+  writeNode(cursor);
 }
 
 /**
- * @brief Function called to remove internally into leaf into B+ Tree
- * @param x 
- * @param cursor
- * @param child
- * @param child
- * @return  
+ * @brief Function called to delete the pages of the index, from the disk and
+ * from the buffer pool
+ *
  */
-void bplusTree::removeInternal(int x, Node* cursor, Node* child) {
-	Node* root = getRoot();
-
-	// Check if key from root is to deleted
-	if (cursor == root) {
-		if (cursor->size == 1) {
-			// If only one key is left and matches with one of the
-			// child Pointers
-			if (cursor->ptr[1] == child) {
-				this->root = cursor->ptr[0];
-				//delete cursor;
-				cout << "Wow! New Changed Root" <<endl;
-				return;
-			}
-			else if (cursor->ptr[0] == child) {
-				this->root = cursor->ptr[1];
-				//delete cursor;
-				cout << "Wow! New Changed Root" << endl;
-				return;
-			}
-		}
-	}
-
-	// Deleting key x from the parent
-	int pos;
-	for (pos = 0; pos < cursor->size; pos++) {
-		if (cursor->key[pos] == x) {
-			break;
-		}
-	}
-	for (int i = pos; i < cursor->size-1; i++) {
-		cursor->key[i] = cursor->key[i + 1];
-	}
-	cursor->size = cursor->size - 1;
-
-	// Now deleting the ptr2tree
-	for (pos = 0; pos < cursor->size; pos++) {
-		if (cursor->ptr[pos] == child) {
-			break;
-		}
-	}
-
-	for (int i = pos; i < cursor->size - 1; i++) {
-		cursor->ptr[i] = cursor->ptr[i + 1];
-	}
-
-	// If there is No underflow. Phew!!
-	if (cursor->size >= (this->MAX + 1) / 2 - 1) {
-		cout << "Deleted " << x << " from internal node successfully\n";
-		return;
-	}
-
-	cout << "UnderFlow in internal Node! What did you do :/" << endl;
-
-	if (cursor == root) {
-		return;
-	}
-
-	Node* p1 = findParent(root, cursor);
-	Node* parent = p1;
-
-	int leftSibling, rightSibling;
-
-	// Finding Left and Right Siblings as we did earlier
-	for (pos = 0; pos < parent->size; pos++) {
-		if (parent->ptr[pos] == cursor) {
-			leftSibling = pos - 1;
-			rightSibling = pos + 1;
-			break;
-		}
-	}
-
-	// If possible transfer to leftSibling
-	if (leftSibling >= 0) {
-		Node* leftNode = parent->ptr[leftSibling];
-
-		//Check if LeftSibling has extra Key to transfer
-		if (leftNode->size >= (this->MAX + 1) / 2 ) {
-
-			//transfer key from left sibling through parent
-			int maxIdx = leftNode->size - 1;
-
-			// insert at start
-			cursor->key[0] = leftNode->key[maxIdx];
-			for (int i = 1; i < cursor->size ; i++)
-			{
-				cursor->key[i] = cursor->key[i - 1];
-			}
-
-			cursor->ptr[0] = leftNode->ptr[maxIdx];
-			for (int i = 1; i < cursor->size ; i++)
-			{
-				cursor->ptr[i] = cursor->ptr[i - 1];
-			}
-			leftNode->size = maxIdx;
-
-			// cursor->keys.insert(cursor->keys.begin(), parent->keys[leftSibling]);
-			// parent->keys[leftSibling] = leftNode->keys[maxIdxKey];
-
-			// int maxIdxPtr = leftNode->ptr2TreeOrData.ptr2Tree.size()-1;
-			// cursor->ptr2TreeOrData.ptr2Tree
-			// 	.insert(cursor->ptr2TreeOrData.ptr2Tree.begin(), leftNode->ptr2TreeOrData.ptr2Tree[maxIdxPtr]);
-
-			// //resize the left Sibling Node After Tranfer
-			// leftNode->keys.resize(maxIdxKey);
-			// leftNode->ptr2TreeOrData.dataPtr.resize(maxIdxPtr);
-
-			return;
-		}
-	}
-
-	// If possible transfer to rightSibling
-	if (rightSibling < parent->size) {
-		Node* rightNode = parent->ptr[rightSibling];
-
-		//Check if LeftSibling has extra Key to transfer
-		if (rightNode->size >= (this->MAX + 1) / 2) {
-
-			//transfer key from right sibling through parent
-			int maxIdxKey = rightNode->size - 1;
-
-			cursor->key[cursor->size++] = parent->key[pos];
-			parent->key[pos] = rightNode->key[0];
-
-			for (int i = 1; i < rightNode->size; i++)
-			{
-				rightNode->key[i] = rightNode->key[i - 1];
-			}
-			rightNode->size--;
-
-			// cursor->keys.push_back(parent->keys[pos]);
-			// parent->keys[pos] = rightNode->key[0];
-			// rightNode->keys.erase(rightNode->keys.begin());
-
-			//transfer the pointer from rightSibling to cursor
-			cursor->ptr[cursor->size++] = rightNode->ptr[0];
-			// cursor->ptr2TreeOrData.ptr2Tree
-			// 	.push_back(rightNode->ptr2TreeOrData.ptr2Tree[0]);
-			for (int i = 1; i < cursor->size; i++)
-			{
-				cursor->key[i] = cursor->key[i - 1];
-			}
-			cursor->size--;
-			// cursor->ptr2TreeOrData.ptr2Tree
-			// 	.erase(cursor->ptr2TreeOrData.ptr2Tree.begin());
-			 
-			return;
-		}
-	}
-
-	//Start to Merge Now, if None of the above cases applied
-	if (leftSibling >= 0) {
-		//leftNode + parent key + cursor
-		Node* leftNode = parent->ptr[leftSibling];
-		leftNode->key[leftNode->size++] = parent->key[leftSibling];
-		// leftNode->keys.push_back(parent->keys[leftSibling]);
-		int orig = leftNode->size - 1;
-		for (int i = 0; i < cursor->size; i++)
-		{
-			leftNode->key[leftNode->size++] = cursor->key[i];
-		}
-		
-		// for (int val : cursor->keys) {
-		// 	leftNode->keys.push_back(val);
-		// }
-
-		for (int i = 0; i < cursor->size; i++) {
-			leftNode->ptr[i + orig + 1] = cursor->ptr[i];
-			// leftNode->ptr2TreeOrData.ptr2Tree
-			// 	.push_back(cursor->ptr2TreeOrData.ptr2Tree[i]);
-			cursor->ptr[i] = NULL;
-		}
-
-		cursor->size = 0;
-		// cursor->ptr2TreeOrData.ptr2Tree.resize(0);
-		// cursor->keys.resize(0);
-
-		removeInternal(parent->key[leftSibling], parent, cursor);
-		cout << "Merged with left sibling"<<endl;
-	}
-	else if (rightSibling < parent->size) {
-		//cursor + parentkey +rightNode
-		Node* rightNode = parent->ptr[rightSibling];
-
-		int orig = cursor->size;
-
-		cursor->key[cursor->size++] = parent->key[rightSibling - 1];
-		// cursor->keys.push_back(parent->keys[rightSibling - 1]);
-
-		// for (int val : rightNode->keys) {
-		// 	cursor->keys.push_back(val);
-		// }
-
-		for (int val = 0; val < rightNode->size; val++)
-		{
-			cursor->key[cursor->size++] = rightNode->key[val];
-		}
-		
-
-		for (int i = 0; i < rightNode->size; i++) {
-			cursor->ptr[i + orig + 1] = rightNode->ptr[i];
-			// cursor->ptr2TreeOrData.ptr2Tree
-			// 	.push_back(rightNode->ptr2TreeOrData.ptr2Tree[i]);
-			rightNode->ptr[i] = NULL;
-		}
-
-		// rightNode->ptr2TreeOrData.ptr2Tree.resize(0);
-		// rightNode->keys.resize(0);
-
-		rightNode->size = 0;
-
-		removeInternal(parent->key[rightSibling - 1], parent, rightNode);
-		cout << "Merged with right sibling\n";
-	}
+void bplusTree::drop() {
+  if (this->indexName == "")
+    return;
+  bufferManager.deleteIndex(this->indexName, this->nodeCount);
+  root = -1;
+  nodeCount = 0;
 }
-
@@ -1,62 +1,112 @@
 namespace std
 {
     /**
- * @brief The BufferManager is responsible for reading pages to the main memory.
- * Recall that large files are broken and stored as blocks in the hard disk. The
- * minimum amount of memory that can be read from the disk is a block whose size
- * is indicated by BLOCK_SIZE. within this system we simulate blocks by
- * splitting and storing the file as multiple files each of one BLOCK_SIZE,
- * although this isn't traditionally how it's done. You can alternatively just
- * random access to the point where a block begins within the same
- * file. In this system we assume that the the sizes of blocks and pages are the
- * same. 
- * 
+ * @brief The bplusTree is a disk resident B+ tree. Every node is a page of the
+ * index, named "<tablename>_BTree<column>_Page<nodeid>", that is read and
+ * written through the BufferManager exactly like the pages of a table, so the
+ * nodes follow the same replacement policy and an index is not limited by the
+ * memory available.
+ *
+ * <p>
+ * A node page is one fixed size row: {IS_LEAF, size} followed by the keys,
+ * pagePtrs, rowPtrs and ptrs of the node, each in its own run of slots. ptr
+ * holds the ids of the child nodes and ptr[size] of a leaf is the id of the
+ * next leaf, -1 at the end of the chain.
+ * </p>
+ *
  * <p>
- * The buffer can hold multiple pages quantified by BLOCK_COUNT. The
- * buffer manager follows the FIFO replacement policy i.e. the first block to be
- * read in is replaced by the new incoming block. This replacement policy should
- * be transparent to the executors i.e. the executor should not know if a block
- * was previously present in the buffer or was read in from the disk. 
+ * Every row has its own entry, so a key with several rows keeps the list of
+ * their locations as a run of equal keys in the leaves, in the order the rows
+ * were indexed. The run may continue into the next leaves.
  * </p>
  *
  */
 
 
 
-// BP node
+// Allocator of the node blocks of one index. Every block of a tree has the
+// same size, so blocks are carved out of large aligned chunks and a released
+// block goes on a free list to be handed out again as is. Dropping the arena
+// frees all of them at once.
+class NodeArena {
+  vector<int *> chunks;
+  vector<int *> freeBlocks;
+
+   public:
+  int capacity;
+  int stride;
+  NodeArena(int capacity);
+  NodeArena(const NodeArena &) = delete;
+  NodeArena &operator=(const NodeArena &) = delete;
+  ~NodeArena();
+  int *allocate();
+  void release(int *block);
+};
+
+// BP node, the in memory image of one index page. The four arrays of a node
+// share one block aligned to a cache line, keys first, and every array is
+// padded to a whole number of cache lines so keys can be compared 4 at a time.
 class Node {
-  friend class bplusTree;
+  shared_ptr<NodeArena> arena;
+  int *block;
+  void allocate(shared_ptr<NodeArena> arena);
 
    public:
+  int id;
   bool IS_LEAF;
-  vector < pair<int,int> > dataPtr;
-  int *key, size;
-  int *rowPtr;
+  int size;
+  int *key;
   int *pagePtr;
-  Node **ptr;
+  int *rowPtr;
+  int *ptr;
 
   Node();
+  Node(int id, bool isLeaf, shared_ptr<NodeArena> arena);
+  Node(const Node &other);
+  Node(Node &&other);
+  Node &operator=(Node other);
+  ~Node();
+  int lowerBound(int x);
+  int upperBound(int x);
 };
 
 // BP tree
 class bplusTree {
-  Node *root;
-  void insertInternal(int key, int pagePtr, int rowPtr, Node * nd1, Node *nd2);
-  Node *findParent(Node *nd1, Node *nd2);
+  int root;
   int MAX;
+  int nodeCount;
+  shared_ptr<NodeArena> arena;
+  Node bulkPrevious;
+  Node bulkLeaf;
+  vector<pair<int,int>> bulkLevel;
+
+  Node newNode(bool isLeaf);
+  Node readNode(int id);
+  void writeNode(Node &nd);
+  void bulkWriteLeaf(Node &nd);
+  Node findLeaf(int x, bool rightmost, vector<pair<int,int>> *path = NULL);
+  bool findEntry(int x, int pagePtr, int rowPtr, Node &cursor, int &pos);
+  void insertInternal(int x, int child, vector<pair<int,int>> &path);
 
    public:
    string tableName;
+   string indexName;
   bplusTree();
 
-  void removeKey(int x);
-  void removeInternal(int x, Node* cursor, Node* child);
+  void removeKey(int x, int pagePtr, int rowPtr);
   bplusTree(string tableName, string fanOut, int rowCount, int indexedColumn);
   pair<int,int>  search(int key);
+  pair<int,int> searchFirst(int low, int high);
+  vector<pair<int,int>> searchRange(int low, int high);
+  vector<int> searchKeys(int low, int high);
   void searchAndUpdate(int x, int pagePtr, int rowPtr);
+  void relocate(int x, int pagePtr, int rowPtr, int newRowPtr);
   void insert(int x, int pagePtr, int rowPtr);
-  void display(Node * nd);
-  Node *getRoot();
+  void bulkInsert(int x, int pagePtr, int rowPtr);
+  void bulkBuild();
+  void display(int nodeId);
+  int getRoot();
+  void drop();
 };
 
 
@@ -3,11 +3,25 @@
 BufferManager::BufferManager()
 {
     logger.log("BufferManager::BufferManager");
+    this->flusher = thread(&BufferManager::flushInBackground, this);
+}
+
+BufferManager::~BufferManager()
+{
+    {
+        lock_guard<mutex> lock(this->poolMutex);
+        this->stopping = true;
+    }
+    this->flushSignal.notify_one();
+    this->flusher.join();
+    this->flushPages();
 }
 
 /**
  * @brief Function called to read a page from the buffer manager. If the page is
  * not present in the pool, the page is read and then inserted into the pool.
+ * Safe to call from several threads at once; only the pool lookup and the
+ * insertion are serialised, the page file itself is read outside the lock.
  *
  * @param tableName 
  * @param pageIndex 
@@ -20,19 +34,44 @@ Page BufferManager::getPage(string tableName, int pageIndex)
     string pageName = "../data/temp/"+tableName + "_Page" + to_string(pageIndex);
     logger.log("searching");
     logger.log(pageName);
-    if (this->inPool(pageName) && tableName.at(0) != '_' && tableName != "Y" )
     {
-        // cout << "IN POOOL IN POOOL IN POOL "<< endl;;
-        return this->getFromPool(pageName);
-    }
-    else
+        lock_guard<mutex> lock(this->poolMutex);
+        if (this->inPool(pageName) && tableName.at(0) != '_' && tableName != "Y" )
         {
-            // cout << "mother board  \n";
-            logger.log(tableName);
-            logger.log("ANNARA");
-            logger.log("TERERERE");
-            return this->insertIntoPool(tableName, pageIndex);
+            // cout << "IN POOOL IN POOOL IN POOL "<< endl;;
+            return this->getFromPool(pageName);
         }
+    }
+    // cout << "mother board  \n";
+    logger.log(tableName);
+    logger.log("ANNARA");
+    logger.log("TERERERE");
+    return this->insertIntoPool(tableName, pageIndex);
+}
+
+/**
+ * @brief Function called to read only some columns of a page of a table. A
+ * page in the pool is returned whole. Otherwise a PAX page is read from its
+ * file, the minipages of those columns alone, and not inserted into the pool
+ * since the others read 0; any other page is read as by getPage.
+ *
+ * @param tableName 
+ * @param pageIndex 
+ * @param columnIndices 
+ * @return Page 
+ */
+Page BufferManager::getPage(string tableName, int pageIndex, vector<int> columnIndices)
+{
+    logger.log("BufferManager::getPage");
+    if (columnIndices.empty() || !tableCatalogue.isTable(tableName) || tableCatalogue.getTable(tableName)->pageLayout != PAX)
+        return this->getPage(tableName, pageIndex);
+    string pageName = "../data/temp/"+tableName + "_Page" + to_string(pageIndex);
+    {
+        lock_guard<mutex> lock(this->poolMutex);
+        if (this->inPool(pageName))
+            return this->getFromPool(pageName);
+    }
+    return Page(tableName, pageIndex, columnIndices);
 }
 
 /**
@@ -45,11 +84,8 @@ Page BufferManager::getPage(string tableName, int pageIndex)
 bool BufferManager::inPool(string pageName)
 {
     logger.log("BufferManager::inPool");
-    for (auto page : this->pages)
+    for (auto &page : this->pages)
     {
-        logger.log("OO");
-        logger.log(page.pageName);
-        // cout << page.pageName << endl;
         if (pageName == page.pageName)
             return true;
     }
@@ -67,17 +103,9 @@ bool BufferManager::inPool(string pageName)
 Page BufferManager::getFromPool(string pageName)
 {
     logger.log("BufferManager::getFromPool");
-    for (auto page : this->pages)
+    for (auto &page : this->pages)
         if (pageName == page.pageName)
-        {
-            // cout << "Buffer returning : " << page.pageName << endl;
-            vector <int> tester = page.getRow(0);
-            // for (auto x : tester){
-            //     cout << x << " ";
-            // } 
-            // cout <<  "POOL puss" << endl; 
             return page;
-        }
 }
 
 /**
@@ -94,27 +122,80 @@ Page BufferManager::insertIntoPool(string tableName, int pageIndex)
     logger.log("BufferManager::insertIntoPool");
     Page page(tableName, pageIndex);
     cout << page.getRowCount() << "  " << tableName << "  " << pageIndex << endl ;
-    if (this->pages.size() >= BLOCK_COUNT)
-        pages.pop_front();
+    lock_guard<mutex> lock(this->poolMutex);
+    this->makeRoom();
     pages.push_back(page);
     vector <int> tester = page.getRow(0);
     return page;
 }
 
+/**
+ * @brief Ejects the oldest page if the pool is full, writing it back first if
+ * it is dirty. Called with the pool locked.
+ */
+void BufferManager::makeRoom()
+{
+    if (this->pages.size() < BLOCK_COUNT)
+        return;
+    if (this->dirtyPages.erase(this->pages.front().pageName))
+        this->pages.front().writePage();
+    this->pages.pop_front();
+}
+
 /**
  * @brief The buffer manager is also responsible for writing pages. This is
- * called when new tables are created using assignment statements.
+ * called when new tables are created using assignment statements. The pooled
+ * copy of the page, if any, is replaced.
  *
  * @param tableName 
  * @param pageIndex 
  * @param rows 
  * @param rowCount 
+ * @param layout 
  */
-void BufferManager::writePage(string tableName, int pageIndex, vector<vector<int>> rows, int rowCount)
+void BufferManager::writePage(string tableName, int pageIndex, vector<vector<int>> rows, int rowCount, PageLayout layout)
 {
     logger.log("BufferManager::writePage");
-    Page page(tableName, pageIndex, rows, rowCount);
+    Page page(tableName, pageIndex, rows, rowCount, layout);
     page.writePage();
+    lock_guard<mutex> lock(this->poolMutex);
+    this->putPage(page, false);
+}
+
+/**
+ * @brief Writes every dirty page of the pool back to the disk. Called with the
+ * pool locked, so no page changes while it is written.
+ */
+void BufferManager::writeDirtyPages()
+{
+    for (auto &page : this->pages)
+        if (this->dirtyPages.erase(page.pageName))
+            page.writePage();
+}
+
+/**
+ * @brief Writes every dirty page of the pool back to the disk
+ */
+void BufferManager::flushPages()
+{
+    logger.log("BufferManager::flushPages");
+    lock_guard<mutex> lock(this->poolMutex);
+    this->writeDirtyPages();
+}
+
+/**
+ * @brief Body of the flusher thread. It writes the dirty pages back every
+ * FLUSH_INTERVAL milliseconds, or as soon as half the pool is dirty, until the
+ * buffer manager is destroyed.
+ */
+void BufferManager::flushInBackground()
+{
+    unique_lock<mutex> lock(this->poolMutex);
+    while (!this->stopping)
+    {
+        this->flushSignal.wait_for(lock, chrono::milliseconds(FLUSH_INTERVAL), [this] { return this->stopping || 2 * this->dirtyPages.size() >= BLOCK_COUNT; });
+        this->writeDirtyPages();
+    }
 }
 
 /**
@@ -125,23 +206,46 @@ void BufferManager::writePage(string tableName, int pageIndex, vector<vector<int
  * @param pageIndex 
  * @param rows 
  * @param rowCount 
+ * @param dirty true if newPage has not been written, it is then kept in the
+ * pool until it is written back
  */
-void BufferManager::updatePage(string pageName,Page newPage)
+void BufferManager::updatePage(string pageName,Page newPage, bool dirty)
 {
     cout << "trying to update page " << newPage.pageName << " with rows " << newPage.getRowCount() << endl;
     logger.log("BufferManager::updatePage");
-    int x = 0;
-    for (auto page : this->pages)
+    lock_guard<mutex> lock(this->poolMutex);
+    this->putPage(newPage, dirty);
+}
+
+/**
+ * @brief Replaces the pooled copies of a page. A dirty page that is not in
+ * the pool is added to it, as it is nowhere else. Called with the pool locked.
+ *
+ * @param newPage 
+ * @param dirty 
+ */
+void BufferManager::putPage(Page &newPage, bool dirty)
+{
+    bool found = false;
+    for (auto &page : this->pages)
+        if (page.pageName == newPage.pageName)
         {
-            // cout << "|" << page.pageName << "|" << endl;
-            if ("../data/temp/" + pageName == page.pageName)
-            {
-                    // cout << "ALLU ARJUN ANNAYA" << endl;;
-                    this->pages[x] = newPage;
-                    page = newPage;
-            }
-            x++;
+            page = newPage;
+            found = true;
         }
+    if (!dirty)
+    {
+        this->dirtyPages.erase(newPage.pageName);
+        return;
+    }
+    if (!found)
+    {
+        this->makeRoom();
+        this->pages.push_back(newPage);
+    }
+    this->dirtyPages.insert(newPage.pageName);
+    if (2 * this->dirtyPages.size() >= BLOCK_COUNT)
+        this->flushSignal.notify_one();
 }
 
 
@@ -155,6 +259,7 @@ void BufferManager::unloadPage(string pageName)
 {
     cout << "trying to delete page " << pageName << " with rows " << pageName << endl;
     logger.log("BufferManager::removePage");
+    lock_guard<mutex> lock(this->poolMutex);
     int x = 0;
     for (auto page : this->pages)
         {
@@ -162,6 +267,8 @@ void BufferManager::unloadPage(string pageName)
             if ( pageName == page.pageName)
             {
                 cout << "UNLOADED" << endl;
+                if (this->dirtyPages.erase(pageName))
+                    this->pages[x].writePage();
                 this->pages[x].pageName = "dummyPage";                 
             }
             x++;
@@ -173,6 +280,8 @@ void BufferManager::unloadPages()
 {
     cout << "trying to delete page "  << endl;
     logger.log("BufferManager::removePage");
+    lock_guard<mutex> lock(this->poolMutex);
+    this->writeDirtyPages();
     int x = 0;
     for (auto page : this->pages)
         {
@@ -208,9 +317,84 @@ void BufferManager::deleteFile(string tableName, int pageIndex)
 {
     logger.log("BufferManager::deleteFile");
     string fileName = "../data/temp/"+tableName + "_Page" + to_string(pageIndex);
+    {
+        // a dirty copy left in the pool would bring the file back
+        lock_guard<mutex> lock(this->poolMutex);
+        this->dirtyPages.erase(fileName);
+        for (auto &page : this->pages)
+            if (page.pageName == fileName)
+                page.pageName = "dummyPage";
+    }
     this->deleteFile(fileName);
 }
 
+//////////////////////////    INDEX METHODS          /////////////////////////////
+/**
+ * @brief Function called to read a page of an index. Index pages share the
+ * pool, and so the replacement policy, with the pages of tables.
+ *
+ * @param indexName 
+ * @param pageIndex 
+ * @param columnCount integers per row of the page
+ * @return Page 
+ */
+Page BufferManager::getIndexPage(string indexName, int pageIndex, int columnCount)
+{
+    logger.log("BufferManager::getIndexPage");
+    string pageName = "../data/temp/" + indexName + "_Page" + to_string(pageIndex);
+    {
+        lock_guard<mutex> lock(this->poolMutex);
+        if (this->inPool(pageName))
+            return this->getFromPool(pageName);
+    }
+    Page page(indexName, pageIndex, columnCount);
+    lock_guard<mutex> lock(this->poolMutex);
+    this->makeRoom();
+    pages.push_back(page);
+    return page;
+}
+
+/**
+ * @brief Function called to write a page of an index. The pooled copy is
+ * replaced, or the page added to the pool, and marked dirty; the file is
+ * written back later.
+ *
+ * @param indexName 
+ * @param pageIndex 
+ * @param rows 
+ */
+void BufferManager::writeIndexPage(string indexName, int pageIndex, vector<vector<int>> rows)
+{
+    logger.log("BufferManager::writeIndexPage");
+    Page page(indexName, pageIndex, rows, rows.size());
+    lock_guard<mutex> lock(this->poolMutex);
+    this->putPage(page, true);
+}
+
+/**
+ * @brief Function called to delete every page of an index, from the pool and
+ * from the disk.
+ *
+ * @param indexName 
+ * @param pageCount 
+ */
+void BufferManager::deleteIndex(string indexName, int pageCount)
+{
+    logger.log("BufferManager::deleteIndex");
+    string prefix = "../data/temp/" + indexName + "_Page";
+    {
+        lock_guard<mutex> lock(this->poolMutex);
+        for (int pageCounter = 0; pageCounter < this->pages.size(); pageCounter++)
+            if (this->pages[pageCounter].pageName.compare(0, prefix.size(), prefix) == 0)
+            {
+                this->dirtyPages.erase(this->pages[pageCounter].pageName);
+                this->pages[pageCounter].pageName = "dummyPage";
+            }
+    }
+    for (int pageCounter = 0; pageCounter < pageCount; pageCounter++)
+        this->deleteFile(indexName, pageCounter);
+}
+
 //////////////////////////    MATRIX METHODS         /////////////////////////////
 /**
  * @brief Inserts page indicated by matrixName and pageIndex into pool. If the
@@ -225,8 +409,8 @@ Page BufferManager::insertMatrixIntoPool(string matrixName, int pageIndex)
 {
     logger.log("BufferManager::insertMatrixIntoPool");
     Page page(matrixName, pageIndex);
-    if (this->pages.size() >= BLOCK_COUNT)
-        pages.pop_front();
+    lock_guard<mutex> lock(this->poolMutex);
+    this->makeRoom();
     pages.push_back(page);
     return page;
 }
@@ -18,12 +18,29 @@
  * be transparent to the executors i.e. the executor should not know if a block
  * was previously present in the buffer or was read in from the disk. 
  * </p>
+ * <p>
+ * A page can be changed in the pool alone and marked dirty. It is written to
+ * the disk when it is ejected, when the pool is flushed, or by the flusher
+ * thread, which writes the dirty pages every FLUSH_INTERVAL milliseconds. A
+ * page changed by many statements in between is written once.
+ * </p>
  *
  */
 class BufferManager{
 
     deque<Page> pages; 
+    // pages changed in the pool only, written back when they leave it
+    unordered_set<string> dirtyPages;
+    mutex poolMutex;
+    // wakes the flusher early once many pages are dirty
+    condition_variable flushSignal;
+    bool stopping = false;
+    thread flusher;
     Page getFromPool(string pageName);
+    void makeRoom();
+    void putPage(Page &newPage, bool dirty);
+    void writeDirtyPages();
+    void flushInBackground();
 
     // Table
     Page insertIntoPool(string tableName, int pageIndex);
@@ -31,18 +48,26 @@ class BufferManager{
     public:
     
     BufferManager();
+    ~BufferManager();
 
     // Table Methods
     bool inPool(string pageName);
     Page getPage(string tableName, int pageIndex);
+    Page getPage(string tableName, int pageIndex, vector<int> columnIndices);
     void unloadPage(string pageName);
     void unloadPages();
     void writePage(string pageName, vector<vector<int>> rows);
     void deleteFile(string tableName, int pageIndex);
     void deleteFile(string fileName);
-    void writePage(string tableName, int pageIndex, vector<vector<int>> rows, int rowCount);
+    void writePage(string tableName, int pageIndex, vector<vector<int>> rows, int rowCount, PageLayout layout = ROW_MAJOR);
+    void flushPages();
+
+    // Index Methods
+    Page getIndexPage(string indexName, int pageIndex, int columnCount);
+    void writeIndexPage(string indexName, int pageIndex, vector<vector<int>> rows);
+    void deleteIndex(string indexName, int pageCount);
 
     // Matrix Methods
     Page insertMatrixIntoPool(string MatrixName, int pageIndex);
-    void updatePage(string pageName,Page newPage);
+    void updatePage(string pageName,Page newPage, bool dirty = false);
 };
\ No newline at end of file
@@ -0,0 +1,381 @@
+#include "global.h"
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// values bit-packed together, 32 in each of four lanes
+const int PACKED_BLOCK_SIZE = 128;
+// a page with more distinct values in a column gets no dictionary for it
+const uint DICTIONARY_LIMIT = 1 << 16;
+
+/**
+ * @brief Number of bits the integers 0 to range take
+ */
+static uint bitWidth(uint32_t range)
+{
+    return range ? 32 - __builtin_clz(range) : 0;
+}
+
+/**
+ * @brief Bytes taken by count values bit-packed in width bits each
+ */
+static size_t packedSize(int count, uint width)
+{
+    return (size_t)((count + PACKED_BLOCK_SIZE - 1) / PACKED_BLOCK_SIZE) * width * 16;
+}
+
+template <typename T>
+static void appendValue(string &minipage, T value)
+{
+    minipage.append((const char *)&value, sizeof(T));
+}
+
+template <typename T>
+static T readValue(const char *&data)
+{
+    T value;
+    memcpy(&value, data, sizeof(T));
+    data += sizeof(T);
+    return value;
+}
+
+/**
+ * @brief Appends codes bit-packed in width bits each. Code 4p + l of a block
+ * goes to lane l at bit p * width, so the codes a shift extracts from the
+ * four lanes are neighbours.
+ *
+ * @param codes every one below 2^width
+ * @param width
+ * @param minipage
+ */
+static void packBits(const vector<uint32_t> &codes, uint width, string &minipage)
+{
+    if (!width)
+        return;
+    vector<uint32_t> words(4 * width);
+    for (int blockStart = 0; blockStart < codes.size(); blockStart += PACKED_BLOCK_SIZE)
+    {
+        fill(words.begin(), words.end(), 0);
+        for (int position = 0; position < PACKED_BLOCK_SIZE / 4; position++)
+        {
+            uint bit = position * width;
+            uint word = bit >> 5, shift = bit & 31;
+            for (int lane = 0; lane < 4; lane++)
+            {
+                int codeIndex = blockStart + 4 * position + lane;
+                uint64_t code = codeIndex < codes.size() ? codes[codeIndex] : 0;
+                words[4 * word + lane] |= (uint32_t)(code << shift);
+                if (shift + width > 32)
+                    words[4 * (word + 1) + lane] |= (uint32_t)(code >> (32 - shift));
+            }
+        }
+        minipage.append((const char *)words.data(), words.size() * sizeof(uint32_t));
+    }
+}
+
+/**
+ * @brief Unpacks count codes of width bits each and adds base to every one.
+ * The output is written a whole block at a time, so it must have room for
+ * count rounded up to PACKED_BLOCK_SIZE values.
+ *
+ * @param data the packed codes
+ * @param count
+ * @param width
+ * @param base
+ * @param values out
+ */
+static void unpackBits(const char *data, int count, uint width, uint32_t base, int *values)
+{
+    uint32_t mask = width == 32 ? UINT32_MAX : (1u << width) - 1;
+    for (int blockStart = 0; blockStart < count; blockStart += PACKED_BLOCK_SIZE)
+    {
+        const char *words = data + (size_t)(blockStart / PACKED_BLOCK_SIZE) * width * 16;
+        int *blockValues = values + blockStart;
+#ifdef __SSE2__
+        __m128i baseLanes = _mm_set1_epi32(base);
+        __m128i maskLanes = _mm_set1_epi32(mask);
+        for (int position = 0; position < PACKED_BLOCK_SIZE / 4; position++)
+        {
+            __m128i lanes = _mm_setzero_si128();
+            if (width)
+            {
+                uint bit = position * width;
+                uint word = bit >> 5, shift = bit & 31;
+                lanes = _mm_srl_epi32(_mm_loadu_si128((const __m128i *)(words + 16 * word)), _mm_cvtsi32_si128(shift));
+                if (shift + width > 32)
+                    lanes = _mm_or_si128(lanes, _mm_sll_epi32(_mm_loadu_si128((const __m128i *)(words + 16 * (word + 1))), _mm_cvtsi32_si128(32 - shift)));
+                lanes = _mm_and_si128(lanes, maskLanes);
+            }
+            _mm_storeu_si128((__m128i *)(blockValues + 4 * position), _mm_add_epi32(lanes, baseLanes));
+        }
+#else
+        for (int position = 0; position < PACKED_BLOCK_SIZE / 4; position++)
+        {
+            uint bit = position * width;
+            uint word = bit >> 5, shift = bit & 31;
+            for (int lane = 0; lane < 4; lane++)
+            {
+                uint64_t code = 0;
+                if (width)
+                {
+                    uint32_t low, high = 0;
+                    memcpy(&low, words + 16 * word + 4 * lane, sizeof(low));
+                    if (shift + width > 32)
+                        memcpy(&high, words + 16 * (word + 1) + 4 * lane, sizeof(high));
+                    code = ((low | (uint64_t)high << 32) >> shift) & mask;
+                }
+                blockValues[4 * position + lane] = (int)((uint32_t)code + base);
+            }
+        }
+#endif
+    }
+}
+
+/**
+ * @brief Sets the bits first to last - 1 of a selection bitmap
+ */
+static void selectRange(vector<uint64_t> &selection, int first, int last)
+{
+    for (; first < last && (first & 63); first++)
+        selection[first >> 6] |= 1ULL << (first & 63);
+    for (; first + 64 <= last; first += 64)
+        selection[first >> 6] = UINT64_MAX;
+    for (; first < last; first++)
+        selection[first >> 6] |= 1ULL << (first & 63);
+}
+
+/**
+ * @brief Encodes the values of a column in a page in whichever encoding
+ * takes the fewest bytes
+ *
+ * @param values
+ * @return string the minipage
+ */
+string encodeColumn(const vector<int> &values)
+{
+    int count = values.size();
+    string minipage;
+    if (!count)
+    {
+        minipage += PLAIN_ENCODING;
+        return minipage;
+    }
+
+    int minValue = values[0], maxValue = values[0];
+    uint32_t minDelta = UINT32_MAX, maxDelta = 0;
+    bool sorted = true;
+    uint runCount = 1;
+    for (int valueCounter = 1; valueCounter < count; valueCounter++)
+    {
+        minValue = min(minValue, values[valueCounter]);
+        maxValue = max(maxValue, values[valueCounter]);
+        if (values[valueCounter] != values[valueCounter - 1])
+            runCount++;
+        if (values[valueCounter] < values[valueCounter - 1])
+            sorted = false;
+        uint32_t delta = (uint32_t)values[valueCounter] - (uint32_t)values[valueCounter - 1];
+        minDelta = min(minDelta, delta);
+        maxDelta = max(maxDelta, delta);
+    }
+    vector<int> dictionary;
+    if (runCount <= DICTIONARY_LIMIT)
+    {
+        dictionary = values;
+        sort(dictionary.begin(), dictionary.end());
+        dictionary.erase(unique(dictionary.begin(), dictionary.end()), dictionary.end());
+    }
+
+    ColumnEncoding encoding = PLAIN_ENCODING;
+    size_t size = 1 + 4 * (size_t)count;
+    uint forWidth = bitWidth((uint32_t)maxValue - (uint32_t)minValue);
+    if (1 + 4 + 1 + packedSize(count, forWidth) < size)
+        encoding = FRAME_OF_REFERENCE, size = 1 + 4 + 1 + packedSize(count, forWidth);
+    uint deltaWidth = count > 1 ? bitWidth(maxDelta - minDelta) : 0;
+    if (sorted && count > 1 && 1 + 4 + 4 + 1 + packedSize(count - 1, deltaWidth) < size)
+        encoding = DELTA_ENCODING, size = 1 + 4 + 4 + 1 + packedSize(count - 1, deltaWidth);
+    if (1 + 4 + 8 * (size_t)runCount < size)
+        encoding = RUN_LENGTH, size = 1 + 4 + 8 * (size_t)runCount;
+    uint dictionaryWidth = bitWidth(dictionary.size() - 1);
+    if (!dictionary.empty() && dictionary.size() <= DICTIONARY_LIMIT && 1 + 4 + 4 * dictionary.size() + 1 + packedSize(count, dictionaryWidth) < size)
+        encoding = DICTIONARY;
+
+    minipage += encoding;
+    vector<uint32_t> codes;
+    switch (encoding)
+    {
+    case PLAIN_ENCODING:
+        minipage.append((const char *)values.data(), 4 * (size_t)count);
+        break;
+    case FRAME_OF_REFERENCE:
+        appendValue<int32_t>(minipage, minValue);
+        appendValue<uint8_t>(minipage, forWidth);
+        for (int value : values)
+            codes.push_back((uint32_t)value - (uint32_t)minValue);
+        packBits(codes, forWidth, minipage);
+        break;
+    case DELTA_ENCODING:
+        appendValue<int32_t>(minipage, values[0]);
+        appendValue<uint32_t>(minipage, minDelta);
+        appendValue<uint8_t>(minipage, deltaWidth);
+        for (int valueCounter = 1; valueCounter < count; valueCounter++)
+            codes.push_back((uint32_t)values[valueCounter] - (uint32_t)values[valueCounter - 1] - minDelta);
+        packBits(codes, deltaWidth, minipage);
+        break;
+    case RUN_LENGTH:
+    {
+        appendValue<uint32_t>(minipage, runCount);
+        int runStart = 0;
+        for (int valueCounter = 1; valueCounter <= count; valueCounter++)
+        {
+            if (valueCounter < count && values[valueCounter] == values[runStart])
+                continue;
+            appendValue<int32_t>(minipage, values[runStart]);
+            appendValue<uint32_t>(minipage, valueCounter - runStart);
+            runStart = valueCounter;
+        }
+        break;
+    }
+    case DICTIONARY:
+        appendValue<uint32_t>(minipage, dictionary.size());
+        minipage.append((const char *)dictionary.data(), 4 * dictionary.size());
+        appendValue<uint8_t>(minipage, dictionaryWidth);
+        for (int value : values)
+            codes.push_back(lower_bound(dictionary.begin(), dictionary.end(), value) - dictionary.begin());
+        packBits(codes, dictionaryWidth, minipage);
+        break;
+    }
+    return minipage;
+}
+
+/**
+ * @brief Decodes the count values of a minipage
+ *
+ * @param minipage
+ * @param count
+ * @param values out
+ */
+void decodeColumn(const string &minipage, int count, vector<int> &values)
+{
+    // room for the last block unpacked whole, and the delta that shifts it
+    values.resize((count + PACKED_BLOCK_SIZE - 1) / PACKED_BLOCK_SIZE * PACKED_BLOCK_SIZE + 1);
+    const char *data = minipage.data() + 1;
+    switch (minipage.empty() ? PLAIN_ENCODING : minipage[0])
+    {
+    case PLAIN_ENCODING:
+        memcpy(values.data(), data, 4 * (size_t)count);
+        break;
+    case FRAME_OF_REFERENCE:
+    {
+        int base = readValue<int32_t>(data);
+        uint width = readValue<uint8_t>(data);
+        unpackBits(data, count, width, base, values.data());
+        break;
+    }
+    case DELTA_ENCODING:
+    {
+        values[0] = readValue<int32_t>(data);
+        uint32_t minDelta = readValue<uint32_t>(data);
+        uint width = readValue<uint8_t>(data);
+        unpackBits(data, count - 1, width, minDelta, values.data() + 1);
+        for (int valueCounter = 1; valueCounter < count; valueCounter++)
+            values[valueCounter] = (int)((uint32_t)values[valueCounter - 1] + (uint32_t)values[valueCounter]);
+        break;
+    }
+    case RUN_LENGTH:
+    {
+        uint runCount = readValue<uint32_t>(data);
+        int *value = values.data();
+        for (uint runCounter = 0; runCounter < runCount; runCounter++)
+        {
+            int runValue = readValue<int32_t>(data);
+            uint length = readValue<uint32_t>(data);
+            value = fill_n(value, length, runValue);
+        }
+        break;
+    }
+    case DICTIONARY:
+    {
+        uint dictionarySize = readValue<uint32_t>(data);
+        const char *dictionary = data;
+        data += 4 * (size_t)dictionarySize;
+        uint width = readValue<uint8_t>(data);
+        unpackBits(data, count, width, 0, values.data());
+        for (int valueCounter = 0; valueCounter < count; valueCounter++)
+            memcpy(&values[valueCounter], dictionary + 4 * (size_t)values[valueCounter], 4);
+        break;
+    }
+    }
+    values.resize(count);
+}
+
+/**
+ * @brief Evaluates a predicate on a minipage without decoding it, when its
+ * encoding allows: once per run of a RUN_LENGTH minipage, once per value of
+ * the dictionary of a DICTIONARY one, once for a FRAME_OF_REFERENCE minipage
+ * of a single value.
+ *
+ * @param minipage
+ * @param count
+ * @param matches the predicate
+ * @param selection out: the values that satisfy it, as a bitmap
+ * @return false if the minipage has to be decoded instead
+ */
+bool selectEncodedColumn(const string &minipage, int count, function<bool(int)> matches, vector<uint64_t> &selection)
+{
+    if (minipage.empty())
+        return false;
+    const char *data = minipage.data() + 1;
+    switch (minipage[0])
+    {
+    case FRAME_OF_REFERENCE:
+    {
+        int base = readValue<int32_t>(data);
+        if (readValue<uint8_t>(data))
+            return false;
+        selection.assign((count + 63) / 64, 0);
+        if (matches(base))
+            selectRange(selection, 0, count);
+        return true;
+    }
+    case RUN_LENGTH:
+    {
+        selection.assign((count + 63) / 64, 0);
+        uint runCount = readValue<uint32_t>(data);
+        int runStart = 0;
+        for (uint runCounter = 0; runCounter < runCount; runCounter++)
+        {
+            int runValue = readValue<int32_t>(data);
+            uint length = readValue<uint32_t>(data);
+            if (matches(runValue))
+                selectRange(selection, runStart, runStart + length);
+            runStart += length;
+        }
+        return true;
+    }
+    case DICTIONARY:
+    {
+        selection.assign((count + 63) / 64, 0);
+        uint dictionarySize = readValue<uint32_t>(data);
+        vector<char> qualifies(dictionarySize);
+        uint qualifyingCount = 0;
+        for (uint entry = 0; entry < dictionarySize; entry++)
+            qualifyingCount += qualifies[entry] = matches(readValue<int32_t>(data));
+        uint width = readValue<uint8_t>(data);
+        if (qualifyingCount == 0)
+            return true;
+        if (qualifyingCount == dictionarySize)
+        {
+            selectRange(selection, 0, count);
+            return true;
+        }
+        // only the codes are unpacked, never the values
+        vector<int> codes((count + PACKED_BLOCK_SIZE - 1) / PACKED_BLOCK_SIZE * PACKED_BLOCK_SIZE);
+        unpackBits(data, count, width, 0, codes.data());
+        for (int valueCounter = 0; valueCounter < count; valueCounter++)
+            selection[valueCounter >> 6] |= (uint64_t)qualifies[codes[valueCounter]] << (valueCounter & 63);
+        return true;
+    }
+    default:
+        return false;
+    }
+}
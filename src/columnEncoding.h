@@ -0,0 +1,31 @@
+/**
+ * @brief How a minipage of a PAX page is encoded. Every column of every page
+ * is written in whichever of these is smallest for its values, named by the
+ * first byte of the minipage:
+ *
+ * <p>
+ * PLAIN_ENCODING, the values as 32 bit integers. FRAME_OF_REFERENCE, the
+ * smallest value of the page and every value less it, bit-packed in as many
+ * bits as the largest needs. DELTA_ENCODING, for a column sorted in the page,
+ * its first value and the differences between neighbours, bit-packed likewise.
+ * RUN_LENGTH, a value and a length per run of equal values. DICTIONARY, the
+ * distinct values of the page, sorted, and the bit-packed position of every
+ * value among them.
+ * </p>
+ * <p>
+ * Values are bit-packed by blocks of PACKED_BLOCK_SIZE, dealt out to four
+ * 32 bit lanes, so that one shift and one mask unpack four values at a time.
+ * </p>
+ */
+enum ColumnEncoding : char
+{
+    PLAIN_ENCODING = 'P',
+    FRAME_OF_REFERENCE = 'F',
+    DELTA_ENCODING = 'D',
+    RUN_LENGTH = 'R',
+    DICTIONARY = 'C'
+};
+
+string encodeColumn(const vector<int> &values);
+void decodeColumn(const string &minipage, int count, vector<int> &values);
+bool selectEncodedColumn(const string &minipage, int count, function<bool(int)> matches, vector<uint64_t> &selection);
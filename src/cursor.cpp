@@ -1,9 +1,18 @@
 #include "global.h"
 
-Cursor::Cursor(string tableName, int pageIndex)
+/**
+ * @brief Construct a new Cursor. A cursor given columns may leave the others
+ * out of the rows it reads, they read 0.
+ *
+ * @param tableName 
+ * @param pageIndex 
+ * @param columnIndices 
+ */
+Cursor::Cursor(string tableName, int pageIndex, vector<int> columnIndices)
 {
     logger.log("Cursor::Cursor");
-    this->page = bufferManager.getPage(tableName, pageIndex);
+    this->columnIndices = columnIndices;
+    this->page = bufferManager.getPage(tableName, pageIndex, columnIndices);
     this->pagePointer = 0;
     this->tableName = tableName;
     this->pageIndex = pageIndex;
@@ -12,7 +21,8 @@ Cursor::Cursor(string tableName, int pageIndex)
 /**
  * @brief This function reads the next row from the page. The index of the
  * current row read from the page is indicated by the pagePointer(points to row
- * in page the cursor is pointing to).
+ * in page the cursor is pointing to). Rows deleted from a table but still in
+ * their page are skipped.
  *
  * @return vector<int> 
  */
@@ -21,24 +31,29 @@ vector<int> Cursor::getNext()
     logger.log("Cursor::getNext");
     vector<int> result = this->page.getRow(this->pagePointer);
     this->pagePointer++;
-    if(result.empty()){
-        if(tableCatalogue.isTable(this->tableName)){
-            // this is a table
-            tableCatalogue.getTable(this->tableName)->getNextPage(this);
-            cout << "page pointer: " << this->pagePointer << endl;
-            if(!this->pagePointer){
-                cout << "got in smh" << endl;
-                result = this->page.getRow(this->pagePointer);
-                this->pagePointer++;
+    if(tableCatalogue.isTable(this->tableName)){
+        // this is a table
+        Table *table = tableCatalogue.getTable(this->tableName);
+        while (result.empty() || table->isDeleted(this->pageIndex, this->pagePointer - 1))
+        {
+            if (result.empty())
+            {
+                // move on, past empty pages, until the last page is done
+                int pageIndex = this->pageIndex;
+                table->getNextPage(this);
+                if (this->pageIndex == pageIndex)
+                    break;
             }
+            result = this->page.getRow(this->pagePointer);
+            this->pagePointer++;
         }
-        else{
-            logger.log("MATRIX UTHA RAHA HUN");
-            matrixCatalogue.getMatrix(this->tableName)->getNextPage(this);
-            if(!this->pagePointer){
-                result = this->page.getRow(this->pagePointer);
-                this->pagePointer++;
-            }
+    }
+    else if(result.empty()){
+        logger.log("MATRIX UTHA RAHA HUN");
+        matrixCatalogue.getMatrix(this->tableName)->getNextPage(this);
+        if(!this->pagePointer){
+            result = this->page.getRow(this->pagePointer);
+            this->pagePointer++;
         }
     }
     return result;
@@ -53,7 +68,7 @@ vector<int> Cursor::getNext()
 void Cursor::nextPage(int pageIndex)
 {
     logger.log("Cursor::nextPage");
-    this->page = bufferManager.getPage(this->tableName, pageIndex);
+    this->page = bufferManager.getPage(this->tableName, pageIndex, this->columnIndices);
     this->pageIndex = pageIndex;
     this->pagePointer = 0;
 }
\ No newline at end of file
@@ -11,9 +11,11 @@ class Cursor{
     int pageIndex;
     string tableName;
     int pagePointer;
+    // columns the rows are read for, all of them if empty
+    vector<int> columnIndices;
 
     public:
-    Cursor(string tableName, int pageIndex);
+    Cursor(string tableName, int pageIndex, vector<int> columnIndices = {});
     vector<int> getNext();
     void nextPage(int pageIndex);
 };
\ No newline at end of file
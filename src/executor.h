@@ -1,6 +1,7 @@
 #include"semanticParser.h"
 
 void executeCommand();
+void doCommand();
 
 void executeCLEAR();
 void executeCROSS();
@@ -26,4 +27,7 @@ void executeALTER();
 void executeBULK_INSERT();
 
 bool evaluateBinOp(int value1, int value2, BinaryOperator binaryOperator);
+bool predicateRange(BinaryOperator binaryOperator, int value, long long &low, long long &high);
+bool zoneMapMayMatch(Table *table, int pageIndex, int firstColumnIndex, int secondColumnIndex, int value2, BinaryOperator binaryOperator);
+void evaluateBinOpColumn(const int *values1, const int *values2, int value2, int count, BinaryOperator binaryOperator, vector<uint64_t> &selection);
 void printRowCount(int rowCount);
\ No newline at end of file
@@ -1,13 +1,15 @@
 #include "global.h"
 /**
  * @brief 
- * SYNTAX: Alter table 
+ * SYNTAX: ALTER TABLE relation_name ADD|DELETE COLUMN column_name
+ *         ALTER TABLE relation_name ADD COLUMN column_name DEFAULT int_literal
  */
 bool syntacticParseALTER()
 {
     cout << "parsing AL syntax " << endl;
     logger.log("syntacticParseALTER");
-    if (tokenizedQuery.size() != 6 || tokenizedQuery[1] != "TABLE" || tokenizedQuery[4] != "COLUMN")
+    bool withDefault = tokenizedQuery.size() == 8 && tokenizedQuery[3] == "ADD" && tokenizedQuery[6] == "DEFAULT";
+    if ((tokenizedQuery.size() != 6 && !withDefault) || tokenizedQuery[1] != "TABLE" || tokenizedQuery[4] != "COLUMN")
     {
         cout << "SYNTAX ERROR" << endl;
         return false;
@@ -16,6 +18,16 @@ bool syntacticParseALTER()
     parsedQuery.alterRelationName = tokenizedQuery[2];
     parsedQuery.alterOperation = tokenizedQuery[3];
     parsedQuery.alterColumnName = tokenizedQuery[5];
+    if (withDefault)
+    {
+        regex numeric("[-]?[0-9]+");
+        if (!regex_match(tokenizedQuery[7], numeric))
+        {
+            cout << "SYNTAX ERROR" << endl;
+            return false;
+        }
+        parsedQuery.alterDefaultValue = stoi(tokenizedQuery[7]);
+    }
     return true;
 }
 
@@ -60,23 +72,36 @@ void executeALTER()
 {
     logger.log("executeALTER");
     Table *table = tableCatalogue.getTable(parsedQuery.alterRelationName);
+    wal.logStatement(table);
+    if (parsedQuery.alterOperation == "ADD")
+    {
+        // only the metadata changes, the pages and the indexes stay
+        table->addCol(parsedQuery.alterColumnName, parsedQuery.alterDefaultValue);
+        return;
+    }
+    string sourceFileName = table->sourceFileName;
     bool indexed = table->indexed;
     IndexingStrategy indexingStrategy = table->indexingStrategy;
     string thirdParam   = table->thirdParam;
     string indexedColumn = table->indexedColumn;
-    if (parsedQuery.alterOperation == "ADD")
-    {
-        table->addCol(parsedQuery.alterColumnName);
-    }
-    else if (parsedQuery.alterOperation == "DELETE")
-    {
-        table->deleteCol(parsedQuery.alterColumnName);
-    }
+    vector<SecondaryIndex> secondaryIndexes = table->secondaryIndexes;
+    table->deleteCol(parsedQuery.alterColumnName);
     if(indexed){
         Table * tabl = tableCatalogue.getTable(parsedQuery.alterRelationName);
         if(tabl){
             tabl->indexTable(indexedColumn,indexingStrategy,thirdParam);
         }
     }
+    // the altered table is a new one, index again the columns it kept
+    Table *altered = tableCatalogue.getTable(parsedQuery.alterRelationName);
+    // the altered table still has the csv of the old one, and a log
+    if (altered && altered->sourceFileName != sourceFileName)
+    {
+        bufferManager.deleteFile(altered->sourceFileName);
+        altered->sourceFileName = sourceFileName;
+    }
+    for (SecondaryIndex &secondaryIndex : secondaryIndexes)
+        if (altered && altered->isColumn(secondaryIndex.column))
+            altered->addSecondaryIndex(secondaryIndex.column, secondaryIndex.indexingStrategy, secondaryIndex.thirdParam);
     return;
 }
\ No newline at end of file
@@ -34,45 +34,22 @@ bool semanticParseBULK_INSERT()
     return true;
 }
 
+/**
+ * @brief The rows are read into one batch, and inserted together so that the
+ * indexes of the table take their entries in bulk
+ */
 void executeBULK_INSERT()
 {
-    logger.log("executeLOAD");
+    logger.log("executeBULK_INSERT");
     Table *table = tableCatalogue.getTable(parsedQuery.bulkInsertRelationName);
-    bool indexed = table->indexed;
-    IndexingStrategy indexingStrategy = table->indexingStrategy;
-    string thirdParam   = table->thirdParam;
-    string indexedColumn = table->indexedColumn;
 
     fstream newfile;
     newfile.open("../data/"+parsedQuery.bulkFromRelationName+".csv",ios::in);
 
     string word;
-
-    bool lpflag =1;
-
-
-    int num;
     string input;
     vector<int> row(table->columnCount, 0);
-    vector<vector<int>> lastPageRows (table->maxRowsPerBlock, row);
-    int pageCounter=0;
-
-
-
-    //last block got space
-    if (table->rowsPerBlockCount[table->blockCount - 1] < table->maxRowsPerBlock)
-    {
-        lpflag = 0;
-        num = table->maxRowsPerBlock - table->rowsPerBlockCount[table->blockCount - 1];
-        
-        Page lastpage = bufferManager.getPage(table->tableName,table->blockCount-1);
-        lastPageRows = lastpage.getRows();  
-        int lpcount = table->rowsPerBlockCount[table->blockCount - 1];
-
-        vector<int> row(table->columnCount, 0);
-        pageCounter = table->rowsPerBlockCount[table->blockCount - 1];
-
-    }
+    vector<vector<int>> rows;
 
     //getting columns 
     getline(newfile,input);
@@ -80,58 +57,24 @@ void executeBULK_INSERT()
     while  (getline(newfile,input))
     {
         stringstream s(input);
-        for (int columnCounter = 0; columnCounter < table->columnCount; columnCounter++)
+        int columnCounter = 0;
+        for (; columnCounter < table->columnCount; columnCounter++)
         {
-            
             if (!getline(s, word, ','))
-                return ;
+                break;
             row[columnCounter] = stoi(word);
-            lastPageRows[pageCounter][columnCounter] = row[columnCounter];
-
-            
-        }
-        pageCounter++;
-
-
-        //last page full
-        if (pageCounter == table->maxRowsPerBlock && !lpflag  ){
-
-            lpflag =1;        
-
-            // bufferManager.updatePage();
-            bufferManager.writePage(table->tableName, table->blockCount-1, lastPageRows, pageCounter);
-
-            table->rowsPerBlockCount[table->blockCount-1] = table->maxRowsPerBlock;
-            pageCounter = 0;
-            // lastPageRows.clear()
-                        
-        }
-
-
-
-        //writing to new page 
-        else if (pageCounter == table->maxRowsPerBlock && lpflag  ){
-            bufferManager.writePage(table->tableName, table->blockCount, lastPageRows , pageCounter);
-            table->blockCount++;
-            table->rowsPerBlockCount.emplace_back(pageCounter);
-            pageCounter = 0;                            
-        }
-
-    }
-    if (pageCounter)
-    {
-        bufferManager.writePage(table->tableName, table->blockCount, lastPageRows , pageCounter);
-        table->blockCount++;
-        table->rowsPerBlockCount.emplace_back(pageCounter);
-        pageCounter = 0;
-    }
-    if(indexed){
-        Table * tabl = tableCatalogue.getTable(parsedQuery.bulkInsertRelationName);
-        if(tabl){
-            tabl->indexTable(indexedColumn,indexingStrategy,thirdParam);
         }
+        // the rows up to a short one are inserted
+        if (columnCounter < table->columnCount)
+            break;
+        rows.push_back(row);
+        // logged as the row it is, the csv read may change before a replay
+        string record = "INSERT INTO " + table->tableName + " VALUES";
+        for (int value : row)
+            record += " " + to_string(value);
+        wal.logStatement(table, record);
     }
-
+    table->insertRows(rows);
 }
     
 
@@ -1,45 +1,186 @@
-#include "global.h"
-
-/**
- * @brief 
- * SYNTAX: R <- DISTINCT relation_name
- */
-bool syntacticParseDELETE()
-{
-    logger.log("syntacticParseDELETE");
-    parsedQuery.queryType = DELETE;
-    parsedQuery.deleteRelationName = tokenizedQuery[2];
-    string str = tokenizedQuery[4];
-    parsedQuery.deleteValues.clear();
-    for (int stp=0;stp<tokenizedQuery.size()-4;stp++) {
-        int val1 = stoi(tokenizedQuery[stp+4]);
-        parsedQuery.deleteValues.push_back(val1);
-    }
-    return true;
-}
-
-bool semanticParseDELETE()
-{
-    logger.log("semanticParseDELETE");
-    //The resultant table shouldn't exist and the table argument should
-    if (!tableCatalogue.isTable(parsedQuery.deleteRelationName))
-    {
-        cout << "SEMANTIC ERROR: Resultant relation doesnt exist" << endl;
-        return false;
-    }
-    return true;
-}
-
-void executeDELETE()
-{
-    logger.log("executeDELETE");
-    for (int stp=0;stp<tokenizedQuery.size()-4;stp++) {
-        int val1 = stoi(tokenizedQuery[stp+4]);
-    }
-    Table * table = tableCatalogue.getTable(parsedQuery.deleteRelationName);
-    int ret = table->deleteRow(parsedQuery.deleteValues);
-    if(!ret){
-        cout << "NO SUCH RELATION FOUND" << endl;
-    }
-    return;
-}
\ No newline at end of file
+#include "global.h"
+
+/**
+ * @brief
+ * SYNTAX: DELETE FROM relation_name VALUES int_literal, int_literal, ...
+ *         DELETE FROM relation_name WHERE column_name bin_op int_literal
+ */
+bool syntacticParseDELETE()
+{
+    logger.log("syntacticParseDELETE");
+    if (tokenizedQuery.size() < 5 || tokenizedQuery[1] != "FROM")
+    {
+        cout << "SYNTAX ERROR" << endl;
+        return false;
+    }
+    parsedQuery.queryType = DELETE;
+    parsedQuery.deleteRelationName = tokenizedQuery[2];
+    if (tokenizedQuery[3] == "WHERE")
+        return syntacticParseDELETEWHERE();
+    string str = tokenizedQuery[4];
+    parsedQuery.deleteValues.clear();
+    for (int stp=0;stp<tokenizedQuery.size()-4;stp++) {
+        int val1 = stoi(tokenizedQuery[stp+4]);
+        parsedQuery.deleteValues.push_back(val1);
+    }
+    return true;
+}
+
+/**
+ * @brief A DELETE with a WHERE clause removes every row that satisfies a
+ * predicate on a literal, with one statement
+ */
+bool syntacticParseDELETEWHERE()
+{
+    logger.log("syntacticParseDELETEWHERE");
+    regex numeric("[-]?[0-9]+");
+    if (tokenizedQuery.size() != 7 || !regex_match(tokenizedQuery[6], numeric))
+    {
+        cout << "SYNTAX ERROR" << endl;
+        return false;
+    }
+    parsedQuery.deleteColumnName = tokenizedQuery[4];
+    parsedQuery.deleteIntLiteral = stoi(tokenizedQuery[6]);
+    string binaryOperator = tokenizedQuery[5];
+    if (binaryOperator == "<")
+        parsedQuery.deleteBinaryOperator = LESS_THAN;
+    else if (binaryOperator == ">")
+        parsedQuery.deleteBinaryOperator = GREATER_THAN;
+    else if (binaryOperator == ">=" || binaryOperator == "=>")
+        parsedQuery.deleteBinaryOperator = GEQ;
+    else if (binaryOperator == "<=" || binaryOperator == "=<")
+        parsedQuery.deleteBinaryOperator = LEQ;
+    else if (binaryOperator == "==")
+        parsedQuery.deleteBinaryOperator = EQUAL;
+    else if (binaryOperator == "!=")
+        parsedQuery.deleteBinaryOperator = NOT_EQUAL;
+    else
+    {
+        cout << "SYNTAX ERROR" << endl;
+        return false;
+    }
+    return true;
+}
+
+bool semanticParseDELETE()
+{
+    logger.log("semanticParseDELETE");
+    //The resultant table shouldn't exist and the table argument should
+    if (!tableCatalogue.isTable(parsedQuery.deleteRelationName))
+    {
+        cout << "SEMANTIC ERROR: Resultant relation doesnt exist" << endl;
+        return false;
+    }
+    if (parsedQuery.deleteColumnName != "" && !tableCatalogue.isColumnFromTable(parsedQuery.deleteColumnName, parsedQuery.deleteRelationName))
+    {
+        cout << "SEMANTIC ERROR: Column doesn't exist in relation" << endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Finds every row satisfying the WHERE clause. An index on the column
+ * answers the predicate when it can, otherwise the pages are scanned, the
+ * ones the zone map rules out unread. The rows found are grouped by page.
+ *
+ * @param table
+ * @param deleteSets out, the slots of the rows found in every page
+ */
+void locateDELETEWHERE(Table *table, map<int, vector<int>> &deleteSets)
+{
+    logger.log("locateDELETEWHERE");
+    int columnIndex = table->getColumnIndex(parsedQuery.deleteColumnName);
+    BinaryOperator binaryOperator = parsedQuery.deleteBinaryOperator;
+    int value = parsedQuery.deleteIntLiteral;
+    long long low, high;
+    bool range = predicateRange(binaryOperator, value, low, high);
+    bool primary = table->indexed && table->indexedColumn == parsedQuery.deleteColumnName;
+    SecondaryIndex *secondaryIndex = table->getSecondaryIndex(parsedQuery.deleteColumnName);
+    vector<pair<int, int>> locations;
+    bool located = true;
+    // the delta store of a B+tree table is in no primary index
+    bool scanDelta = table->indexed && table->indexingStrategy == BTREE;
+
+    if (range && low > high)
+        scanDelta = false;
+    else if (primary && table->indexingStrategy == BTREE && range)
+    {
+        locations = table->BplusTree.searchRange(low, high);
+        vector<vector<int>> deltaRows;
+        table->searchDelta(low, high, locations, deltaRows);
+        scanDelta = false;
+    }
+    else if (primary && table->indexingStrategy == HASH && binaryOperator == EQUAL)
+        locations = table->Hashing.searchElement(value);
+    else if (secondaryIndex && secondaryIndex->indexingStrategy == BTREE && range)
+    {
+        locations = secondaryIndex->BplusTree.searchRange(low, high);
+        scanDelta = false;
+    }
+    else if (secondaryIndex && secondaryIndex->indexingStrategy == HASH && binaryOperator == EQUAL)
+    {
+        locations = secondaryIndex->Hashing.searchElement(value);
+        scanDelta = false;
+    }
+    else if (secondaryIndex && secondaryIndex->indexingStrategy == BITMAP)
+    {
+        RoaringBitmap rows;
+        for (auto &bitmap : secondaryIndex->Bitmap.bitmaps)
+            if (evaluateBinOp(bitmap.first, value, binaryOperator))
+                rows |= bitmap.second;
+        locations = secondaryIndex->Bitmap.locate(rows);
+        scanDelta = false;
+    }
+    else
+        located = false;
+
+    for (auto &location : locations)
+        deleteSets[location.first].push_back(location.second);
+    for (auto &deleteSet : deleteSets)
+        sort(deleteSet.second.begin(), deleteSet.second.end());
+
+    if (!located)
+    {
+        for (int pageCounter = 0; pageCounter < table->blockCount; pageCounter++)
+        {
+            if (!table->rowsPerBlockCount[pageCounter] || !zoneMapMayMatch(table, pageCounter, columnIndex, -1, value, binaryOperator))
+                continue;
+            Page page = bufferManager.getPage(table->tableName, pageCounter);
+            vector<vector<int>> rows = page.getRows();
+            for (int rowCounter = 0; rowCounter < table->rowsPerBlockCount[pageCounter]; rowCounter++)
+                if (evaluateBinOp(rows[rowCounter][columnIndex], value, binaryOperator) && !table->isDeleted(pageCounter, rowCounter))
+                    deleteSets[pageCounter].push_back(rowCounter);
+        }
+    }
+    if (scanDelta)
+    {
+        for (int pageIndex : table->getDeltaPages())
+        {
+            Page page = bufferManager.getPage(table->tableName, pageIndex);
+            vector<vector<int>> rows = page.getRows();
+            for (int rowCounter = 0; rowCounter < page.getRowCount(); rowCounter++)
+                if (evaluateBinOp(rows[rowCounter][columnIndex], value, binaryOperator))
+                    deleteSets[pageIndex].push_back(rowCounter);
+        }
+    }
+}
+
+void executeDELETE()
+{
+    logger.log("executeDELETE");
+    Table * table = tableCatalogue.getTable(parsedQuery.deleteRelationName);
+    wal.logStatement(table);
+    if (parsedQuery.deleteColumnName != "")
+    {
+        map<int, vector<int>> deleteSets;
+        locateDELETEWHERE(table, deleteSets);
+        printRowCount(table->deleteRows(deleteSets));
+        return;
+    }
+    int ret = table->deleteRow(parsedQuery.deleteValues);
+    if(!ret){
+        cout << "NO SUCH RELATION FOUND" << endl;
+    }
+    return;
+}
@@ -1,16 +1,13 @@
 #include "global.h"
 /**
  * @brief 
- * SYNTAX: R <- SELECT column_name bin_op [column_name | int_literal] FROM relation_name
+ * SYNTAX: R <- GROUP BY column_name FROM relation_name RETURN aggregate(column_name), ...
+ * aggregate: MIN | MAX | SUM | AVG | COUNT (COUNT also takes *)
  */
 bool syntacticParseGROUP()
 {
-    for (auto k: tokenizedQuery){
-        cout << k <<" ";
-    }
-    cout << endl;
     logger.log("syntacticParseGROUP");
-    if (tokenizedQuery.size() != 10 || tokenizedQuery[5] != "FROM" || tokenizedQuery[7] != "RETURN")
+    if (tokenizedQuery.size() < 10 || tokenizedQuery.size() % 2 != 0 || tokenizedQuery[5] != "FROM" || tokenizedQuery[7] != "RETURN")
     {
         cout << "SYNTAC ERROR" << endl;
         return false;
@@ -19,49 +16,31 @@ bool syntacticParseGROUP()
     parsedQuery.groupResultRelationName = tokenizedQuery[0];
     parsedQuery.groupColumnName = tokenizedQuery[4];
     parsedQuery.groupRelationName = tokenizedQuery[6];
-    parsedQuery.groupOperationName = tokenizedQuery[8];
-    if (tokenizedQuery[9]!=""){
-       tokenizedQuery[9].pop_back();
-       parsedQuery.groupOperationColumn = tokenizedQuery[9];
-       cout << parsedQuery.groupOperationColumn << endl;
-    }
-    else {
-        cout << "SYNTAC ERROR" << endl;
-        return false;
-    }
-
-
 
-    // string binaryOperator = tokenizedQuery[4];
-    // if (binaryOperator == "<")
-    //     parsedQuery.selectionBinaryOperator = LESS_THAN;
-    // else if (binaryOperator == ">")
-    //     parsedQuery.selectionBinaryOperator = GREATER_THAN;
-    // else if (binaryOperator == ">=" || binaryOperator == "=>")
-    //     parsedQuery.selectionBinaryOperator = GEQ;
-    // else if (binaryOperator == "<=" || binaryOperator == "=<")
-    //     parsedQuery.selectionBinaryOperator = LEQ;
-    // else if (binaryOperator == "==")
-    //     parsedQuery.selectionBinaryOperator = EQUAL;
-    // else if (binaryOperator == "!=")
-    //     parsedQuery.selectionBinaryOperator = NOT_EQUAL;
-    // else
-    // {
-    //     cout << "SYNTAC ERROR" << endl;
-    //     return false;
-    // }
-    // regex numeric("[-]?[0-9]+");
-    // string secondArgument = tokenizedQuery[5];
-    // if (regex_match(secondArgument, numeric))
-    // {
-    //     parsedQuery.selectType = INT_LITERAL;
-    //     parsedQuery.selectionIntLiteral = stoi(secondArgument);
-    // }
-    // else
-    // {
-    //     parsedQuery.selectType = COLUMN;
-    //     parsedQuery.selectionSecondColumnName = secondArgument;
-    // }
+    // every aggregate arrives as two tokens: "MAX" and "b)"
+    for (int tokenCounter = 8; tokenCounter < tokenizedQuery.size(); tokenCounter += 2)
+    {
+        string operationName = tokenizedQuery[tokenCounter];
+        string operationColumn = tokenizedQuery[tokenCounter + 1];
+        if (operationName != "MIN" && operationName != "MAX" && operationName != "SUM" && operationName != "AVG" && operationName != "COUNT")
+        {
+            cout << "SYNTAC ERROR" << endl;
+            return false;
+        }
+        if (operationColumn.back() != ')')
+        {
+            cout << "SYNTAC ERROR" << endl;
+            return false;
+        }
+        operationColumn.pop_back();
+        if (operationColumn == "" || (operationColumn == "*" && operationName != "COUNT"))
+        {
+            cout << "SYNTAC ERROR" << endl;
+            return false;
+        }
+        parsedQuery.groupOperationNames.emplace_back(operationName);
+        parsedQuery.groupOperationColumns.emplace_back(operationColumn);
+    }
     return true;
 }
 
@@ -86,10 +65,21 @@ bool semanticParseGROUP()
         cout << "SEMANTIC ERROR: Column "  << parsedQuery.groupColumnName  <<" doesn't exist in relation" << endl;
         return false;
     }
-    if (!tableCatalogue.isColumnFromTable(parsedQuery.groupOperationColumn, parsedQuery.groupRelationName))
+    unordered_set<string> resultColumns;
+    for (int operationCounter = 0; operationCounter < parsedQuery.groupOperationNames.size(); operationCounter++)
     {
-        cout << "SEMANTIC ERROR: Column "  << parsedQuery.groupOperationColumn  <<" doesn't exist in relation" << endl;
-        return false;
+        string operationColumn = parsedQuery.groupOperationColumns[operationCounter];
+        if (operationColumn != "*" && !tableCatalogue.isColumnFromTable(operationColumn, parsedQuery.groupRelationName))
+        {
+            cout << "SEMANTIC ERROR: Column "  << operationColumn  <<" doesn't exist in relation" << endl;
+            return false;
+        }
+        if (resultColumns.count(parsedQuery.groupOperationNames[operationCounter] + operationColumn))
+        {
+            cout << "SEMANTIC ERROR: Aggregate repeated in RETURN list" << endl;
+            return false;
+        }
+        resultColumns.insert(parsedQuery.groupOperationNames[operationCounter] + operationColumn);
     }
 
     return true;
@@ -119,336 +109,238 @@ bool evaluateBinOp(int value1, int value2, BinaryOperator binaryOperator)
 }
 */
 
-void executeGROUP()
+/**
+ * @brief Running state of one aggregate over the rows of a group. All
+ * aggregates of a GROUP query are folded in the same scan, so MIN, MAX, SUM,
+ * AVG and COUNT are kept side by side instead of one scan per operation. The
+ * state is kept as partials (AVG as sum and count) so that states built by
+ * different threads can be merged exactly.
+ */
+struct AggregateState
 {
-    logger.log("executeSELECTION");
+    int min = INT_MAX;
+    int max = INT_MIN;
+    long long sum = 0;
+    long long count = 0;
 
-    if (parsedQuery.groupOperationName=="MAX"){
-        cout << "gotta find group max" << endl;
-    }
-
-    if (parsedQuery.groupOperationName=="MIN"){
-        cout << "gotta find group min" << endl;
+    void add(int value)
+    {
+        this->min = std::min(this->min, value);
+        this->max = std::max(this->max, value);
+        this->sum += value;
+        this->count++;
     }
 
-    if (parsedQuery.groupOperationName=="SUM"){
-        cout << "gotta find group sum" << endl;
+    void merge(const AggregateState &other)
+    {
+        this->min = std::min(this->min, other.min);
+        this->max = std::max(this->max, other.max);
+        this->sum += other.sum;
+        this->count += other.count;
     }
 
-    if (parsedQuery.groupOperationName=="AVG"){
-        cout << "gotta find group avg" << endl;
+    int result(string operationName)
+    {
+        if (operationName == "MIN")
+            return this->min;
+        if (operationName == "MAX")
+            return this->max;
+        if (operationName == "SUM")
+            return (int)this->sum;
+        if (operationName == "AVG")
+            return (int)(this->sum / this->count);
+        return (int)this->count;
     }
+};
 
+typedef unordered_map<int, vector<AggregateState>> GroupTable;
 
-// /*
-    Table tableOG = *tableCatalogue.getTable(parsedQuery.groupRelationName);
-    bool indexed = tableOG.indexed;
-    IndexingStrategy indexingStrategy = tableOG.indexingStrategy;
-    string thirdParam   = tableOG.thirdParam;
-    string indexedColumn = tableOG.indexedColumn;
-
-    tableOG.sortNoIndex(parsedQuery.groupColumnName, "G_sort"+tableOG.tableName);
-
-    Table table = *tableCatalogue.getTable("G_sort"+parsedQuery.groupRelationName);
-    int groupColumnIndex = table.getColumnIndex(parsedQuery.groupColumnName);
-    int oprColumnIndex = table.getColumnIndex(parsedQuery.groupOperationColumn);
-    // int oprColumnIndex1 = tableOG.getColumnIndex(parsedQuery.groupOperationColumn);
-    cout << "oprcolumn " << oprColumnIndex << " name :" << parsedQuery.groupOperationColumn << endl;
-    // cout << "oprcolumn " << oprColumnIndex1 << " name :" << parsedQuery.groupOperationColumn << endl;
-    
-    vector <string> cols;
-    cols.push_back(parsedQuery.groupColumnName);
-    cols.push_back(parsedQuery.groupOperationName+ parsedQuery.groupOperationColumn);
-    Table* resultantTable = new Table(parsedQuery.groupResultRelationName, cols);
-    
-    Cursor cursor = table.getCursor();
-    vector<int> row = cursor.getNext();
-    
-
-
-
-    if (parsedQuery.groupOperationName=="MAX"){
-        
-        int curgrpval;
-        int result = -1;
-        bool  flaggy =0;
-
-        if (!row.empty()){
-            curgrpval = row[groupColumnIndex];
-            result = row[oprColumnIndex];
-            flaggy=1;
-        }
-        else {
-            cout << "empty table" << endl;
-        }
-
-
-        while (!row.empty()){
-            if (curgrpval == row[groupColumnIndex]){
-                
-                if (row[oprColumnIndex] > result){
-                    result = row[oprColumnIndex];
-                }
+/**
+ * @brief Partition a group value is merged in. Every thread-local table is
+ * split the same way so one merger sees all partials of a group.
+ */
+int groupPartition(int groupValue, int partitionCount)
+{
+    return (int)(hash<int>()(groupValue) % partitionCount);
+}
 
-                cout << "cont row: ";
-                for (auto x : row){
-                    cout << x << " ";
-                }
-                cout << endl;
-                row = cursor.getNext();
-            }
-            else {
-                vector <int> toWrite ; 
-                toWrite.push_back(curgrpval);
-                toWrite.push_back(result);
-                
-                cout << "writing row " << curgrpval << " " << result << endl;
-                resultantTable->writeRow(toWrite);
-                
-                curgrpval = row[groupColumnIndex];
-                result = row[oprColumnIndex];
-                cout << "first group row: ";
-                for (auto x : row){
-                    cout << x << " ";
-                }
-                cout << endl;
-                row = cursor.getNext();
-            }
-        }
-        
-        if (flaggy){
-            vector <int> toWrite ; 
-            toWrite.push_back(curgrpval);
-            toWrite.push_back(result);
-            
-            resultantTable->writeRow(toWrite);
+/**
+ * @brief Worker body of the parallel aggregation. Aggregates the given pages
+ * of the table into a thread-local table and hands the groups back split by
+ * partition. Of a PAX page only the columns aggregated are read.
+ *
+ * @param tableName 
+ * @param pageIndices 
+ * @param groupColumnIndex 
+ * @param oprColumnIndices 
+ * @param partitions out: one group table per partition
+ */
+void aggregatePages(string tableName, vector<int> pageIndices, int groupColumnIndex, vector<int> oprColumnIndices, vector<GroupTable> *partitions)
+{
+    GroupTable localTable;
+    Table *table = tableCatalogue.getTable(tableName);
+    vector<int> columnIndices = oprColumnIndices;
+    columnIndices.push_back(groupColumnIndex);
+    for (int pageCounter : pageIndices)
+    {
+        Page page = bufferManager.getPage(tableName, pageCounter, columnIndices);
+        int rowCount = page.getRowCount();
+        vector<vector<int>> rows = page.getRows();
+        for (int rowCounter = 0; rowCounter < rowCount; rowCounter++)
+        {
+            if (table->isDeleted(pageCounter, rowCounter))
+                continue;
+            vector<AggregateState> &states = localTable[rows[rowCounter][groupColumnIndex]];
+            if (states.empty())
+                states.resize(oprColumnIndices.size());
+            for (int operationCounter = 0; operationCounter < oprColumnIndices.size(); operationCounter++)
+                states[operationCounter].add(rows[rowCounter][oprColumnIndices[operationCounter]]);
         }
-        
     }
+    for (auto &group : localTable)
+        (*partitions)[groupPartition(group.first, partitions->size())][group.first] = group.second;
+}
 
-
-
-    else if (parsedQuery.groupOperationName=="MIN"){
-        
-        int curgrpval;
-        int result = -1;
-        bool  flaggy =0;
-
-        if (!row.empty()){
-            curgrpval = row[groupColumnIndex];
-            result = row[oprColumnIndex];
-            flaggy=1;
-        }
-        else {
-            cout << "empty table" << endl;
-        }
-
-
-        while (!row.empty()){
-            if (curgrpval == row[groupColumnIndex]){
-                
-                if (row[oprColumnIndex] < result){
-                    result = row[oprColumnIndex];
-                }
-
-                cout << "cont row: ";
-                for (auto x : row){
-                    cout << x << " ";
-                }
-                cout << endl;
-                row = cursor.getNext();
-            }
-            else {
-                vector <int> toWrite ; 
-                toWrite.push_back(curgrpval);
-                toWrite.push_back(result);
-                
-                cout << "writing row " << curgrpval << " " << result << endl;
-                resultantTable->writeRow(toWrite);
-                
-                curgrpval = row[groupColumnIndex];
-                result = row[oprColumnIndex];
-                cout << "first group row: ";
-                for (auto x : row){
-                    cout << x << " ";
-                }
-                cout << endl;
-                row = cursor.getNext();
+/**
+ * @brief Merger body of the parallel aggregation. Folds the partials every
+ * worker produced for one partition into a single table.
+ *
+ * @param workerPartitions partitions produced by each worker
+ * @param partition partition this merger owns
+ * @param merged out: merged groups of the partition
+ */
+void mergePartition(vector<vector<GroupTable>> *workerPartitions, int partition, GroupTable *merged)
+{
+    for (auto &partitions : *workerPartitions)
+    {
+        for (auto &group : partitions[partition])
+        {
+            vector<AggregateState> &states = (*merged)[group.first];
+            if (states.empty())
+            {
+                states = group.second;
+                continue;
             }
+            for (int operationCounter = 0; operationCounter < states.size(); operationCounter++)
+                states[operationCounter].merge(group.second[operationCounter]);
         }
-        
-        if (flaggy){
-            vector <int> toWrite ; 
-            toWrite.push_back(curgrpval);
-            toWrite.push_back(result);
-            
-            resultantTable->writeRow(toWrite);
-        }
-        
     }
+}
 
-
-
-    else if (parsedQuery.groupOperationName=="SUM"){
-        
-        int curgrpval;
-        int result = -1;
-        bool  flaggy =0;
-
-        if (!row.empty()){
-            curgrpval = row[groupColumnIndex];
-            result = 0;
-            flaggy=1;
-        }
-        else {
-            cout << "empty table" << endl;
-        }
-
-
-        while (!row.empty()){
-            if (curgrpval == row[groupColumnIndex]){
-                
-                
-                result += row[oprColumnIndex];
-                
-
-                cout << "cont row: ";
-                for (auto x : row){
-                    cout << x << " ";
-                }
-                cout << endl;
-                row = cursor.getNext();
-            }
-            else {
-                vector <int> toWrite ; 
-                toWrite.push_back(curgrpval);
-                toWrite.push_back(result);
-                
-                cout << "writing row " << curgrpval << " " << result << endl;
-
-                resultantTable->writeRow(toWrite);
-                
-                curgrpval = row[groupColumnIndex];
-                result = row[oprColumnIndex];
-                cout << "first group row: ";
-                for (auto x : row){
-                    cout << x << " ";
-                }
-                cout << endl;
-                row = cursor.getNext();
-            }
-        }
-        
-        if (flaggy){
-            vector <int> toWrite ; 
-            toWrite.push_back(curgrpval);
-            toWrite.push_back(result);
-            
-            resultantTable->writeRow(toWrite);
-        }
-        
+/**
+ * @brief Aggregates the rows of the table by a partitioned hash aggregation,
+ * rows in the delta store of a B+tree indexed table included.
+ *
+ * @param table 
+ * @param groupColumnIndex 
+ * @param oprColumnIndices 
+ * @param groups out: the groups in ascending group value
+ */
+void aggregateTable(Table *table, int groupColumnIndex, vector<int> &oprColumnIndices, vector<pair<int, vector<AggregateState>>> &groups)
+{
+    vector<int> pageIndices = table->getDeltaPages();
+    for (int pageCounter = 0; pageCounter < (int)table->blockCount; pageCounter++)
+        pageIndices.push_back(pageCounter);
+    int threadCount = max(1, (int)min((size_t)THREAD_COUNT, pageIndices.size()));
+    int pagesPerThread = (pageIndices.size() + threadCount - 1) / threadCount;
+    vector<vector<GroupTable>> workerPartitions(threadCount, vector<GroupTable>(threadCount));
+    vector<thread> workers;
+    for (int threadCounter = 0; threadCounter < threadCount; threadCounter++)
+    {
+        int firstPage = min((int)pageIndices.size(), threadCounter * pagesPerThread);
+        int lastPage = min((int)pageIndices.size(), firstPage + pagesPerThread);
+        vector<int> threadPages(pageIndices.begin() + firstPage, pageIndices.begin() + lastPage);
+        workers.emplace_back(aggregatePages, table->tableName, threadPages, groupColumnIndex, oprColumnIndices, &workerPartitions[threadCounter]);
     }
+    for (auto &worker : workers)
+        worker.join();
+
+    vector<GroupTable> mergedPartitions(threadCount);
+    workers.clear();
+    for (int partition = 0; partition < threadCount; partition++)
+        workers.emplace_back(mergePartition, &workerPartitions, partition, &mergedPartitions[partition]);
+    for (auto &worker : workers)
+        worker.join();
+
+    for (auto &partition : mergedPartitions)
+        groups.insert(groups.end(), partition.begin(), partition.end());
+    sort(groups.begin(), groups.end(), [](const pair<int, vector<AggregateState>> &group1, const pair<int, vector<AggregateState>> &group2){ return group1.first < group2.first; });
+}
 
+/**
+ * @brief GROUP BY is evaluated as a partitioned hash aggregation. The pages of
+ * the table are split into THREAD_COUNT contiguous ranges, each aggregated by
+ * its own thread into a thread-local table. The partials are then merged by
+ * group-value partition, one thread per partition. The groups are written out
+ * in ascending group value, so the result does not depend on the thread count.
+ *
+ * When every aggregate is over the group column itself and the column has a
+ * B+tree, the query is answered from the leaves of the tree alone: a group is
+ * a run of equal keys, and its aggregates follow from the key and the length
+ * of the run. The pages of the table are not fetched.
+ */
+void executeGROUP()
+{
+    logger.log("executeGROUP");
 
+    Table *table = tableCatalogue.getTable(parsedQuery.groupRelationName);
+    int groupColumnIndex = table->getColumnIndex(parsedQuery.groupColumnName);
 
-    else if (parsedQuery.groupOperationName=="AVG"){
-        
-        int curgrpval;
-        int result = -1;
-        int count;
-        bool  flaggy =0;
-
-        if (!row.empty()){
-            curgrpval = row[groupColumnIndex];
-            result = 0;
-            count = 0; 
-            flaggy=1;
+    // COUNT(*) folds the group column, every row has one
+    vector<int> oprColumnIndices;
+    vector <string> cols;
+    cols.push_back(parsedQuery.groupColumnName);
+    for (int operationCounter = 0; operationCounter < parsedQuery.groupOperationNames.size(); operationCounter++)
+    {
+        string operationColumn = parsedQuery.groupOperationColumns[operationCounter];
+        if (operationColumn == "*")
+        {
+            oprColumnIndices.push_back(groupColumnIndex);
+            cols.push_back(parsedQuery.groupOperationNames[operationCounter]);
         }
-        else {
-            cout << "empty table" << endl;
+        else
+        {
+            oprColumnIndices.push_back(table->getColumnIndex(operationColumn));
+            cols.push_back(parsedQuery.groupOperationNames[operationCounter] + operationColumn);
         }
+    }
+    Table* resultantTable = new Table(parsedQuery.groupResultRelationName, cols);
 
-
-        while (!row.empty()){
-            if (curgrpval == row[groupColumnIndex]){
-                
-                
-                result += row[oprColumnIndex];
-                count++;
-
-                cout << "cont row: ";
-                for (auto x : row){
-                    cout << x << " ";
-                }
-                cout << endl;
-                row = cursor.getNext();
-            }
-            else {
-                vector <int> toWrite ; 
-                toWrite.push_back(curgrpval);
-                toWrite.push_back(result/count);
-                
-                cout << "writing row " << curgrpval << " " << result << endl;
-
-                resultantTable->writeRow(toWrite);
-                
-                curgrpval = row[groupColumnIndex];
-                result = row[oprColumnIndex];
-                count = 1 ;
-
-                cout << "first group row: ";
-                for (auto x : row){
-                    cout << x << " ";
-                }
-                cout << endl;
-                row = cursor.getNext();
-            }
-        }
-        
-        if (flaggy){
-            vector <int> toWrite ; 
-            toWrite.push_back(curgrpval);
-            toWrite.push_back(result/count);
-            
-            resultantTable->writeRow(toWrite);
+    vector<pair<int, vector<AggregateState>>> groups;
+    vector<int> keys;
+    if (count(oprColumnIndices.begin(), oprColumnIndices.end(), groupColumnIndex) == oprColumnIndices.size() && table->indexKeys(parsedQuery.groupColumnName, INT_MIN, INT_MAX, keys))
+    {
+        for (int keyCounter = 0; keyCounter < keys.size();)
+        {
+            int runEnd = upper_bound(keys.begin() + keyCounter, keys.end(), keys[keyCounter]) - keys.begin();
+            AggregateState state;
+            state.min = state.max = keys[keyCounter];
+            state.count = runEnd - keyCounter;
+            state.sum = state.count * keys[keyCounter];
+            groups.emplace_back(keys[keyCounter], vector<AggregateState>(oprColumnIndices.size(), state));
+            keyCounter = runEnd;
         }
-        
     }
+    else
+        aggregateTable(table, groupColumnIndex, oprColumnIndices, groups);
 
+    vector<vector<int>> resultRows;
+    for (auto &group : groups)
+    {
+        vector<int> toWrite;
+        toWrite.push_back(group.first);
+        for (int operationCounter = 0; operationCounter < group.second.size(); operationCounter++)
+            toWrite.push_back(group.second[operationCounter].result(parsedQuery.groupOperationNames[operationCounter]));
+        resultRows.push_back(toWrite);
+    }
+    if (!resultRows.empty())
+        resultantTable->writeRows(resultRows);
 
-    
-
-            
-
-
-    // int secondColumnIndex;
-    // if (parsedQuery.selectType == COLUMN)
-    // while (!row.empty())
-    // {
-
-    //     int value1 = row[firstColumnIndex];
-    //     int value2;
-    //     if (parsedQuery.selectType == INT_LITERAL)
-    //         value2 = parsedQuery.selectionIntLiteral;
-    //     else
-    //         value2 = row[secondColumnIndex];
-    //     if (evaluateBinOp(value1, value2, parsedQuery.selectionBinaryOperator))
-    //         resultantTable->writeRow<int>(row);
-    //     row = cursor.getNext();
-    // }
     if(resultantTable->blockify())
         tableCatalogue.insertTable(resultantTable);
     else{
         cout<<"Empty Table"<<endl;
         delete resultantTable;
     }
-
-    if(indexed){
-        Table * tabl = tableCatalogue.getTable(parsedQuery.groupRelationName);
-        if(tabl){
-            tabl->indexTable(indexedColumn,indexingStrategy,thirdParam);
-        }
-    }
-// */
     return;
-}
\ No newline at end of file
+}
@@ -1,13 +1,18 @@
 #include "global.h"
+
+// most distinct values a column may have to get a bitmap index
+const uint BITMAP_MAX_DISTINCT = 1024;
+
 /**
  * @brief 
  * SYNTAX: INDEX ON column_name FROM relation_name USING indexing_strategy FANOUT/BUCKETS thirdParam
- * indexing_strategy: ASC | DESC | NOTHING
+ * indexing_strategy: BTREE | HASH | BITMAP | NOTHING, BITMAP takes no thirdParam
  */
 bool syntacticParseINDEX()
 {
     logger.log("syntacticParseINDEX");
-    if (tokenizedQuery.size() != 9 || tokenizedQuery[1] != "ON" || tokenizedQuery[3] != "FROM" || tokenizedQuery[5] != "USING")
+    bool bitmap = tokenizedQuery.size() == 7 && tokenizedQuery[6] == "BITMAP";
+    if ((tokenizedQuery.size() != 9 && !bitmap) || tokenizedQuery[1] != "ON" || tokenizedQuery[3] != "FROM" || tokenizedQuery[5] != "USING")
     {
         cout << "SYNTAX ERROR" << endl;
         return false;
@@ -16,11 +21,13 @@ bool syntacticParseINDEX()
     parsedQuery.indexColumnName = tokenizedQuery[2];
     parsedQuery.indexRelationName = tokenizedQuery[4];
     string indexingStrategy = tokenizedQuery[6];
-    parsedQuery.thirdParam = tokenizedQuery[8];
+    parsedQuery.thirdParam = bitmap ? "" : tokenizedQuery[8];
     if (indexingStrategy == "BTREE")
         parsedQuery.indexingStrategy = BTREE;
     else if (indexingStrategy == "HASH")
         parsedQuery.indexingStrategy = HASH;
+    else if (indexingStrategy == "BITMAP")
+        parsedQuery.indexingStrategy = BITMAP;
     else if (indexingStrategy == "NOTHING")
         parsedQuery.indexingStrategy = NOTHING;
     else
@@ -45,7 +52,24 @@ bool semanticParseINDEX()
         cout << "SEMANTIC ERROR: Column doesn't exist in relation" << endl;
         return false;
     }
+    if (parsedQuery.indexingStrategy == BTREE && (parsedQuery.thirdParam.find_first_not_of("0123456789") != string::npos || stoi(parsedQuery.thirdParam) < 2))
+    {
+        cout << "SEMANTIC ERROR: Fanout must be an integer of at least 2" << endl;
+        return false;
+    }
+    if (parsedQuery.indexingStrategy == HASH && (parsedQuery.thirdParam.find_first_not_of("0123456789") != string::npos || stoi(parsedQuery.thirdParam) < 1))
+    {
+        cout << "SEMANTIC ERROR: Number of buckets must be a positive integer" << endl;
+        return false;
+    }
     Table* table = tableCatalogue.getTable(parsedQuery.indexRelationName);
+    // the statistics are from when the table was loaded, columns added since have none
+    uint columnIndex = table->getColumnIndex(parsedQuery.indexColumnName);
+    if (parsedQuery.indexingStrategy == BITMAP && columnIndex < table->distinctValuesPerColumnCount.size() && table->distinctValuesPerColumnCount[columnIndex] > BITMAP_MAX_DISTINCT)
+    {
+        cout << "SEMANTIC ERROR: Column has too many distinct values for a bitmap index" << endl;
+        return false;
+    }
     // if(table->indexed){
     //     cout << "SEMANTIC ERROR: Table already indexed" << endl;
     //     return false;
@@ -30,7 +30,7 @@ bool semanticParseINSERT()
         cout << "SEMANTIC ERROR: Insert relation does not exist" << endl;
         return false;
     }
-    Table table = *tableCatalogue.getTable(parsedQuery.insertRelationName);
+    Table &table = *tableCatalogue.getTable(parsedQuery.insertRelationName);
     if (table.columnCount != parsedQuery.insertValues.size()){
         cout << "SEMANTIC ERROR: values do not match number of columns" << endl;
         return false;
@@ -50,6 +50,7 @@ void executeINSERT()
 {
     logger.log("executeINSERT");
     Table *  table = tableCatalogue.getTable(parsedQuery.insertRelationName);
+    wal.logStatement(table);
     // cout << table ->indexedColumn << " wtf ?? " << endl;
     table->insertRow(parsedQuery.insertValues);
     // insertbtree()
@@ -1,18 +1,20 @@
 #include "global.h"
 /**
  * @brief 
- * SYNTAX: LOAD relation_name
+ * SYNTAX: LOAD relation_name [USING ROW|PAX]
  */
 bool syntacticParseLOAD()
 {
     logger.log("syntacticParseLOAD");
-    if (tokenizedQuery.size() != 2)
+    if (tokenizedQuery.size() != 2 && (tokenizedQuery.size() != 4 || tokenizedQuery[2] != "USING" || (tokenizedQuery[3] != "ROW" && tokenizedQuery[3] != "PAX")))
     {
         cout << "SYNTAX ERROR" << endl;
         return false;
     }
     parsedQuery.queryType = LOAD;
     parsedQuery.loadRelationName = tokenizedQuery[1];
+    if (tokenizedQuery.size() == 4 && tokenizedQuery[3] == "PAX")
+        parsedQuery.loadPageLayout = PAX;
     return true;
 }
 
@@ -38,9 +40,13 @@ void executeLOAD()
     logger.log("executeLOAD");
 
     Table *table = new Table(parsedQuery.loadRelationName);
+    table->pageLayout = parsedQuery.loadPageLayout;
     if (table->load())
     {
         tableCatalogue.insertTable(table);
+        // ALTER, replayed, leaves another table behind
+        wal.replay(parsedQuery.loadRelationName);
+        table = tableCatalogue.getTable(parsedQuery.loadRelationName);
         cout << "Loaded Table. Column Count: " << table->columnCount << " Row Count: " << table->rowCount << endl;
     }
     return;
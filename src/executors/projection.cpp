@@ -47,20 +47,42 @@ bool semanticParsePROJECTION()
     return true;
 }
 
+/**
+ * @brief A projection on a column with a B+tree alone is an index-only scan:
+ * the values are read from the leaves of the tree, in increasing order, and
+ * the pages of the table are never fetched. Any other projection reads the
+ * table row by row.
+ */
 void executePROJECTION()
 {
     logger.log("executePROJECTION");
     Table* resultantTable = new Table(parsedQuery.projectionResultRelationName, parsedQuery.projectionColumnList);
-    Table table = *tableCatalogue.getTable(parsedQuery.projectionRelationName);
-    Cursor cursor = table.getCursor();
+    Table &table = *tableCatalogue.getTable(parsedQuery.projectionRelationName);
     vector<int> columnIndices;
     for (int columnCounter = 0; columnCounter < parsedQuery.projectionColumnList.size(); columnCounter++)
     {
         columnIndices.emplace_back(table.getColumnIndex(parsedQuery.projectionColumnList[columnCounter]));
     }
-    vector<int> row = cursor.getNext();
     vector<int> resultantRow(columnIndices.size(), 0);
 
+    vector<int> keys;
+    if (count(columnIndices.begin(), columnIndices.end(), columnIndices[0]) == columnIndices.size() && table.indexKeys(parsedQuery.projectionColumnList[0], INT_MIN, INT_MAX, keys))
+    {
+        vector<vector<int>> resultantRows;
+        for (int key : keys)
+            resultantRows.emplace_back(columnIndices.size(), key);
+        if (!resultantRows.empty())
+            resultantTable->writeRows(resultantRows);
+        resultantTable->blockify();
+        tableCatalogue.insertTable(resultantTable);
+        return;
+    }
+
+    // the cursor reads the delta store of a B+tree indexed table last, and
+    // of PAX pages only the columns projected
+    Cursor cursor = table.getCursor(columnIndices);
+    vector<int> row = cursor.getNext();
+
     while (!row.empty())
     {
 
@@ -46,6 +46,7 @@ void executeRENAME()
 {
     logger.log("executeRENAME");
     Table* table = tableCatalogue.getTable(parsedQuery.renameRelationName);
+    wal.logStatement(table);
     table->renameColumn(parsedQuery.renameFromColumnName, parsedQuery.renameToColumnName);
     return;
 }
\ No newline at end of file
@@ -1,11 +1,17 @@
 #include "global.h"
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 /**
  * @brief 
  * SYNTAX: R <- SELECT column_name bin_op [column_name | int_literal] FROM relation_name
+ *         R <- SELECT column_name IN int_literal, int_literal, ... FROM relation_name
  */
 bool syntacticParseSELECTION()
 {
     logger.log("syntacticParseSELECTION");
+    if (tokenizedQuery.size() >= 8 && tokenizedQuery[4] == "IN")
+        return syntacticParseSELECTIONIN();
     if (tokenizedQuery.size() != 8 || tokenizedQuery[6] != "FROM")
     {
         cout << "SYNTAC ERROR" << endl;
@@ -49,6 +55,42 @@ bool syntacticParseSELECTION()
     return true;
 }
 
+/**
+ * @brief An IN predicate is an EQUAL that any of the listed literals satisfies.
+ * The literals are kept sorted and without repeats, the first of them is the
+ * selectionIntLiteral.
+ */
+bool syntacticParseSELECTIONIN()
+{
+    logger.log("syntacticParseSELECTIONIN");
+    int fromIndex = tokenizedQuery.size() - 2;
+    if (tokenizedQuery[fromIndex] != "FROM")
+    {
+        cout << "SYNTAC ERROR" << endl;
+        return false;
+    }
+    regex numeric("[-]?[0-9]+");
+    for (int tokenCounter = 5; tokenCounter < fromIndex; tokenCounter++)
+    {
+        if (!regex_match(tokenizedQuery[tokenCounter], numeric))
+        {
+            cout << "SYNTAC ERROR" << endl;
+            return false;
+        }
+        parsedQuery.selectionInValues.push_back(stoi(tokenizedQuery[tokenCounter]));
+    }
+    sort(parsedQuery.selectionInValues.begin(), parsedQuery.selectionInValues.end());
+    parsedQuery.selectionInValues.erase(unique(parsedQuery.selectionInValues.begin(), parsedQuery.selectionInValues.end()), parsedQuery.selectionInValues.end());
+    parsedQuery.queryType = SELECTION;
+    parsedQuery.selectionResultRelationName = tokenizedQuery[0];
+    parsedQuery.selectionFirstColumnName = tokenizedQuery[3];
+    parsedQuery.selectionRelationName = tokenizedQuery[fromIndex + 1];
+    parsedQuery.selectionBinaryOperator = EQUAL;
+    parsedQuery.selectType = INT_LITERAL;
+    parsedQuery.selectionIntLiteral = parsedQuery.selectionInValues[0];
+    return true;
+}
+
 bool semanticParseSELECTION()
 {
     logger.log("semanticParseSELECTION");
@@ -103,6 +145,218 @@ bool evaluateBinOp(int value1, int value2, BinaryOperator binaryOperator)
     }
 }
 
+/**
+ * @brief Checks the zone map (per-page min/max) of a page against a predicate.
+ * Returns false only when no row of the page can satisfy it, so the page can
+ * be skipped without being read.
+ *
+ * @param table 
+ * @param pageIndex 
+ * @param firstColumnIndex left operand column
+ * @param secondColumnIndex right operand column, -1 to compare against value2
+ * @param value2 literal right operand
+ * @param binaryOperator 
+ * @return true if the page may hold a qualifying row
+ */
+bool zoneMapMayMatch(Table *table, int pageIndex, int firstColumnIndex, int secondColumnIndex, int value2, BinaryOperator binaryOperator)
+{
+    if (pageIndex < 0 || pageIndex >= table->minValuesPerBlock.size())
+        return true;
+    int min1 = table->minValuesPerBlock[pageIndex][firstColumnIndex];
+    int max1 = table->maxValuesPerBlock[pageIndex][firstColumnIndex];
+    int min2 = value2, max2 = value2;
+    if (secondColumnIndex != -1)
+    {
+        min2 = table->minValuesPerBlock[pageIndex][secondColumnIndex];
+        max2 = table->maxValuesPerBlock[pageIndex][secondColumnIndex];
+    }
+    if (min1 > max1 || min2 > max2)
+        return false;
+    switch (binaryOperator)
+    {
+    case LESS_THAN:
+        return min1 < max2;
+    case GREATER_THAN:
+        return max1 > min2;
+    case LEQ:
+        return min1 <= max2;
+    case GEQ:
+        return max1 >= min2;
+    case EQUAL:
+        return min1 <= max2 && min2 <= max1;
+    case NOT_EQUAL:
+        return !(min1 == max1 && min2 == max2 && min1 == min2);
+    default:
+        return true;
+    }
+}
+
+#ifdef __SSE2__
+/**
+ * @brief Compares four lanes at a time. The operator is a template parameter so
+ * every kernel compiles down to its own compare sequence with no branch on the
+ * operator inside the loop.
+ */
+template <BinaryOperator binaryOperator>
+inline __m128i compareLanes(__m128i values1, __m128i values2)
+{
+    const __m128i allOnes = _mm_set1_epi32(-1);
+    switch (binaryOperator)
+    {
+    case LESS_THAN:
+        return _mm_cmplt_epi32(values1, values2);
+    case GREATER_THAN:
+        return _mm_cmpgt_epi32(values1, values2);
+    case LEQ:
+        return _mm_xor_si128(_mm_cmpgt_epi32(values1, values2), allOnes);
+    case GEQ:
+        return _mm_xor_si128(_mm_cmplt_epi32(values1, values2), allOnes);
+    case EQUAL:
+        return _mm_cmpeq_epi32(values1, values2);
+    default:
+        return _mm_xor_si128(_mm_cmpeq_epi32(values1, values2), allOnes);
+    }
+}
+#endif
+
+/**
+ * @brief Selection kernel for one binary operator. Evaluates values1[i] op
+ * values2[i] (or op value2 when values2 is NULL) for count values and sets bit
+ * i of the selection bitmap for every value that qualifies.
+ */
+template <BinaryOperator binaryOperator>
+void selectionKernel(const int *values1, const int *values2, int value2, int count, uint64_t *selection)
+{
+    int rowCounter = 0;
+#ifdef __SSE2__
+    __m128i literal = _mm_set1_epi32(value2);
+    for (; rowCounter + 4 <= count; rowCounter += 4)
+    {
+        __m128i lanes1 = _mm_loadu_si128((const __m128i *)(values1 + rowCounter));
+        __m128i lanes2 = values2 ? _mm_loadu_si128((const __m128i *)(values2 + rowCounter)) : literal;
+        uint64_t mask = _mm_movemask_ps(_mm_castsi128_ps(compareLanes<binaryOperator>(lanes1, lanes2)));
+        selection[rowCounter >> 6] |= mask << (rowCounter & 63);
+    }
+#endif
+    for (; rowCounter < count; rowCounter++)
+    {
+        uint64_t bit = evaluateBinOp(values1[rowCounter], values2 ? values2[rowCounter] : value2, binaryOperator);
+        selection[rowCounter >> 6] |= bit << (rowCounter & 63);
+    }
+}
+
+/**
+ * @brief Evaluates a predicate over a whole column at once and returns the
+ * qualifying positions as a bitmap (bit i of word i / 64).
+ *
+ * @param values1 left operand column
+ * @param values2 right operand column, NULL to compare against value2
+ * @param value2 literal right operand
+ * @param count number of values in the column
+ * @param binaryOperator 
+ * @param selection out: selection bitmap
+ */
+void evaluateBinOpColumn(const int *values1, const int *values2, int value2, int count, BinaryOperator binaryOperator, vector<uint64_t> &selection)
+{
+    selection.assign((count + 63) / 64, 0);
+    switch (binaryOperator)
+    {
+    case LESS_THAN:
+        selectionKernel<LESS_THAN>(values1, values2, value2, count, selection.data());
+        break;
+    case GREATER_THAN:
+        selectionKernel<GREATER_THAN>(values1, values2, value2, count, selection.data());
+        break;
+    case LEQ:
+        selectionKernel<LEQ>(values1, values2, value2, count, selection.data());
+        break;
+    case GEQ:
+        selectionKernel<GEQ>(values1, values2, value2, count, selection.data());
+        break;
+    case EQUAL:
+        selectionKernel<EQUAL>(values1, values2, value2, count, selection.data());
+        break;
+    case NOT_EQUAL:
+        selectionKernel<NOT_EQUAL>(values1, values2, value2, count, selection.data());
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+ * @brief Maps a comparison against a literal to the closed range of values
+ * [low, high] that satisfy it. The range is empty when low > high.
+ *
+ * @param binaryOperator 
+ * @param value literal right operand
+ * @param low out
+ * @param high out
+ * @return false for NOT_EQUAL, which is not a range
+ */
+bool predicateRange(BinaryOperator binaryOperator, int value, long long &low, long long &high)
+{
+    low = INT_MIN, high = INT_MAX;
+    if (binaryOperator == EQUAL)
+        low = high = value;
+    else if (binaryOperator == LESS_THAN)
+        high = (long long)value - 1;
+    else if (binaryOperator == LEQ)
+        high = value;
+    else if (binaryOperator == GREATER_THAN)
+        low = (long long)value + 1;
+    else if (binaryOperator == GEQ)
+        low = value;
+    else
+        return false;
+    return true;
+}
+
+/**
+ * @brief Checks a value of the selected column against the predicate on a
+ * literal, an IN list included.
+ *
+ * @param value 
+ * @return true if the value qualifies
+ */
+bool selectionMatches(int value)
+{
+    if (!parsedQuery.selectionInValues.empty())
+        return binary_search(parsedQuery.selectionInValues.begin(), parsedQuery.selectionInValues.end(), value);
+    return evaluateBinOp(value, parsedQuery.selectionIntLiteral, parsedQuery.selectionBinaryOperator);
+}
+
+/**
+ * @brief Fetches the rows an index located and appends the ones that satisfy
+ * the predicate to the resultant table. The locations are visited in
+ * page order so every page is read once.
+ *
+ * @param table 
+ * @param resultantTable 
+ * @param locations (page, row) of the candidate rows
+ * @param firstColumnIndex 
+ */
+void writeLocatedRows(Table *table, Table *resultantTable, vector<pair<int, int>> &locations, int firstColumnIndex)
+{
+    sort(locations.begin(), locations.end());
+    vector<vector<int>> qualifyingRows;
+    for (int locationCounter = 0; locationCounter < locations.size();)
+    {
+        int pageIndex = locations[locationCounter].first;
+        Page page = bufferManager.getPage(table->tableName, pageIndex);
+        vector<vector<int>> rows = page.getRows();
+        qualifyingRows.clear();
+        for (; locationCounter < locations.size() && locations[locationCounter].first == pageIndex; locationCounter++)
+        {
+            int rowIndex = locations[locationCounter].second;
+            if (rowIndex < page.getRowCount() && selectionMatches(rows[rowIndex][firstColumnIndex]))
+                qualifyingRows.push_back(rows[rowIndex]);
+        }
+        if (!qualifyingRows.empty())
+            resultantTable->writeRows(qualifyingRows);
+    }
+}
+
 void executeSELECTION()
 {
     logger.log("executeSELECTION");
@@ -112,159 +366,215 @@ void executeSELECTION()
     Table *resultantTable = new Table(parsedQuery.selectionResultRelationName, table->columns);
     table->checkIndex();
     bool indflag = 1;
-    table->BplusTree.display(table->BplusTree.getRoot());
-    if (table->indexed && parsedQuery.selectType != COLUMN && table->indexedColumn == parsedQuery.selectionFirstColumnName)
+    // the literals an EQUAL or IN predicate looks up
+    vector<int> keys = parsedQuery.selectionInValues;
+    if (keys.empty())
+        keys.push_back(parsedQuery.selectionIntLiteral);
+
+    // the rows of a table of one column are its values, so a B+tree on it
+    // answers a range with an index-only scan of its leaves
+    long long low, high;
+    vector<int> coveredKeys;
+    if (table->columnCount == 1 && parsedQuery.selectType != COLUMN && parsedQuery.selectionInValues.empty() && predicateRange(parsedQuery.selectionBinaryOperator, parsedQuery.selectionIntLiteral, low, high) && (low > high || table->indexKeys(table->columns[0], low, high, coveredKeys)))
+    {
+        indflag = 0;
+        vector<vector<int>> qualifyingRows;
+        for (int key : coveredKeys)
+            qualifyingRows.push_back({key});
+        if (!qualifyingRows.empty())
+            resultantTable->writeRows(qualifyingRows);
+    }
+    else if (table->indexed && parsedQuery.selectType != COLUMN && table->indexedColumn == parsedQuery.selectionFirstColumnName)
     {
         int firstColumnIndex = table->getColumnIndex(parsedQuery.selectionFirstColumnName);
-        if (table->indexingStrategy == BTREE && parsedQuery.selectionBinaryOperator != NOT_EQUAL)
+        if (table->indexingStrategy == BTREE && parsedQuery.selectionBinaryOperator != NOT_EQUAL && parsedQuery.selectionInValues.empty())
         {
+            indflag = 0;
             int valCon = parsedQuery.selectionIntLiteral;
-            pair<int, int> address = table->BplusTree.search(valCon);
-            int page = address.first;
-            int row = address.second;
-            bool checkoverflow =0 ;
-            if (parsedQuery.selectionBinaryOperator == EQUAL)
-            {
-                bool eqflag = 0;
-                Cursor curs(table->tableName, page);
-                vector<int> row = curs.getNext();
-                while (!row.empty())
-                {
-                    indflag = 0;
-                    if (row[firstColumnIndex] == valCon)
-                    {
-
-                        eqflag = 1;
-                        resultantTable->writeRow<int>(row);
-                    }
-                    else if (row[firstColumnIndex] != valCon && eqflag)
-                    {
-                        break;
-                    }
-                    checkoverflow = 1;
+            long long low, high;
+            predicateRange(parsedQuery.selectionBinaryOperator, valCon, low, high);
 
-                    row = curs.getNext();
-                }
-            }
-            else if (parsedQuery.selectionBinaryOperator == LESS_THAN)
+            // the table is clustered on the indexed column, so the range is a
+            // contiguous run of rows starting at the first row the tree finds
+            pair<int, int> firstLocation = {-1, -1};
+            if (low <= high)
+                firstLocation = table->BplusTree.searchFirst(low, high);
+            if (firstLocation.first != -1)
             {
-                Cursor curs(table->tableName, 0);
-                vector<int> row = curs.getNext();
-                while (!row.empty())
+                vector<vector<int>> qualifyingRows;
+                int rowCounter = firstLocation.second;
+                bool rangeOver = false;
+                for (int pageCounter = firstLocation.first; !rangeOver && pageCounter < table->blockCount; pageCounter++)
                 {
-                    indflag = 0;
-                    if (row[firstColumnIndex] < valCon)
+                    Page page = bufferManager.getPage(table->tableName, pageCounter);
+                    vector<vector<int>> rows = page.getRows();
+                    qualifyingRows.clear();
+                    for (; rowCounter < page.getRowCount(); rowCounter++)
                     {
-                        resultantTable->writeRow<int>(row);
+                        if (rows[rowCounter][firstColumnIndex] > high)
+                        {
+                            rangeOver = true;
+                            break;
+                        }
+                        if (!table->isDeleted(pageCounter, rowCounter))
+                            qualifyingRows.push_back(rows[rowCounter]);
                     }
-                    else if (row[firstColumnIndex] >= valCon )
-                    {
-                        break;
-                    }
-                    checkoverflow = 1;
-
-                    row = curs.getNext();
+                    rowCounter = 0;
+                    if (!qualifyingRows.empty())
+                        resultantTable->writeRows(qualifyingRows);
                 }
             }
-            // else if (parsedQuery.selectionBinaryOperator == GREATER_THAN)
-            // {
-            //     cout << " WUERY IS EQ " << page << " " << row;
-            //     bool eqflag = 0;
-            //     Cursor curs(table->tableName, page);
-            //     vector<int> row = curs.getNext();
-            //     while (!row.empty())
-            //     {
-            //         cout << " I AM PRINTING THE ROW I FOUND : ";
-            //         indflag = 0;
-            //         for (auto x : row)
-            //             cout << x << " ";
-            //         cout << endl;
-            //         if (row[firstColumnIndex] == valCon)
-            //         {
-
-            //             eqflag = 1;
-            //             resultantTable->writeRow<int>(row);
-            //         }
-            //         else if (row[firstColumnIndex] != valCon && eqflag)
-            //         {
-            //             break;
-            //         }
-
-            //         row = curs.getNext();
-            //     }                
-            // }
-            else if (parsedQuery.selectionBinaryOperator == LEQ)
-            {               
-                Cursor curs(table->tableName, 0);
-                vector<int> row = curs.getNext();
-                while (!row.empty())
-                {
-                    indflag = 0;
-                    if (row[firstColumnIndex] <= valCon)
-                    {
-                        resultantTable->writeRow<int>(row);
-                    }
-                    else if (row[firstColumnIndex] > valCon )
-                    {
-                        break;
-                    }
-                    checkoverflow = 1;
 
-                    row = curs.getNext();
-                }
-
-            }
-            else if (parsedQuery.selectionBinaryOperator == GEQ)
+            // rows inserted since the last merge are in the delta store
+            if (low <= high)
             {
-            }
-            if (checkoverflow){
-                Page ofage = bufferManager.getPage(table->tableName,-1);
-                vector<vector<int>> ofPageRows = ofage.getRows();
-                for (auto uk : ofPageRows ){
-                    if (evaluateBinOp(uk[firstColumnIndex], valCon  , parsedQuery.selectionBinaryOperator)){
-                        resultantTable->writeRow<int>(uk);
-                    }
-                }  
+                vector<pair<int, int>> deltaLocations;
+                vector<vector<int>> deltaRows;
+                table->searchDelta(low, high, deltaLocations, deltaRows);
+                if (!deltaRows.empty())
+                    resultantTable->writeRows(deltaRows);
             }
         }
         else if (table->indexingStrategy == HASH && parsedQuery.selectionBinaryOperator == EQUAL)
         {
             indflag = 0;
-            int valCon = parsedQuery.selectionIntLiteral;
-            vector <pair <int,int> > addressList =  table->Hashing.searchElement(parsedQuery.selectionIntLiteral);
-            for (auto addr : addressList){
-                Page newpage = bufferManager.getPage(table->tableName,addr.first);
-                vector < vector <int >> rowset  = newpage.getRows();
-                if (evaluateBinOp(rowset[addr.second][firstColumnIndex], valCon  , parsedQuery.selectionBinaryOperator)){
-                    resultantTable->writeRow<int>(rowset[addr.second]);
-                }
+            vector<pair<int, int>> locations;
+            for (int key : keys)
+            {
+                vector<pair<int, int>> keyLocations = table->Hashing.searchElement(key);
+                locations.insert(locations.end(), keyLocations.begin(), keyLocations.end());
+            }
+            writeLocatedRows(table, resultantTable, locations, firstColumnIndex);
+        }
+    }
 
+    // otherwise any secondary index on the column
+    SecondaryIndex *secondaryIndex = table->getSecondaryIndex(parsedQuery.selectionFirstColumnName);
+    if (indflag == 1 && secondaryIndex && parsedQuery.selectType != COLUMN)
+    {
+        int firstColumnIndex = table->getColumnIndex(parsedQuery.selectionFirstColumnName);
+        vector<pair<int, int>> locations;
+        long long low, high;
+        if (secondaryIndex->indexingStrategy == BTREE && !parsedQuery.selectionInValues.empty())
+        {
+            indflag = 0;
+            for (int key : keys)
+            {
+                vector<pair<int, int>> keyLocations = secondaryIndex->BplusTree.searchRange(key, key);
+                locations.insert(locations.end(), keyLocations.begin(), keyLocations.end());
+            }
+        }
+        else if (secondaryIndex->indexingStrategy == BTREE && predicateRange(parsedQuery.selectionBinaryOperator, parsedQuery.selectionIntLiteral, low, high))
+        {
+            indflag = 0;
+            if (low <= high)
+                locations = secondaryIndex->BplusTree.searchRange(low, high);
+        }
+        else if (secondaryIndex->indexingStrategy == HASH && parsedQuery.selectionBinaryOperator == EQUAL)
+        {
+            indflag = 0;
+            for (int key : keys)
+            {
+                vector<pair<int, int>> keyLocations = secondaryIndex->Hashing.searchElement(key);
+                locations.insert(locations.end(), keyLocations.begin(), keyLocations.end());
             }
         }
+        else if (secondaryIndex->indexingStrategy == BITMAP)
+        {
+            // the predicate is answered from the values of the column alone:
+            // the bitmaps of the values that satisfy it are OR-ed together
+            // before any page is read, and only the rows set are fetched
+            indflag = 0;
+            RoaringBitmap rows;
+            for (auto &bitmap : secondaryIndex->Bitmap.bitmaps)
+                if (selectionMatches(bitmap.first))
+                    rows |= bitmap.second;
+            locations = secondaryIndex->Bitmap.locate(rows);
+        }
+        if (indflag == 0)
+            writeLocatedRows(table, resultantTable, locations, firstColumnIndex);
     }
 
-    // no index can be used
+    // no index can be used, filter page at a time
     if (indflag == 1)
     {
         cout << "NO INDEX" << endl;
-        Cursor cursor = table->getCursor();
-        vector<int> row = cursor.getNext();
         int firstColumnIndex = table->getColumnIndex(parsedQuery.selectionFirstColumnName);
-        int secondColumnIndex;
+        int secondColumnIndex = -1;
         if (parsedQuery.selectType == COLUMN)
             secondColumnIndex = table->getColumnIndex(parsedQuery.selectionSecondColumnName);
-        while (!row.empty())
+        vector<int> values1, values2;
+        vector<uint64_t> selection;
+        vector<vector<int>> qualifyingRows;
+        // rows inserted into a B+tree indexed table may still be in its delta store
+        vector<int> pageIndices = table->getDeltaPages();
+        for (int pageCounter = 0; pageCounter < (int)table->blockCount; pageCounter++)
+            pageIndices.push_back(pageCounter);
+        for (int pageCounter : pageIndices)
         {
-            cout << "NO INDEX" << endl;
-            int value1 = row[firstColumnIndex];
-            int value2;
-            if (parsedQuery.selectType == INT_LITERAL)
-                value2 = parsedQuery.selectionIntLiteral;
-            else
-                value2 = row[secondColumnIndex];
-            if (evaluateBinOp(value1, value2, parsedQuery.selectionBinaryOperator))
-                resultantTable->writeRow<int>(row);
-            row = cursor.getNext();
+            if (parsedQuery.selectionInValues.empty() && !zoneMapMayMatch(table, pageCounter, firstColumnIndex, secondColumnIndex, parsedQuery.selectionIntLiteral, parsedQuery.selectionBinaryOperator))
+                continue;
+            // an IN list can only match a page that overlaps its range
+            if (!parsedQuery.selectionInValues.empty() && !(zoneMapMayMatch(table, pageCounter, firstColumnIndex, -1, keys.front(), GEQ) && zoneMapMayMatch(table, pageCounter, firstColumnIndex, -1, keys.back(), LEQ)))
+                continue;
+            // of a PAX page the predicate columns are read first, the others
+            // only if a row qualifies
+            vector<int> predicateColumns = {firstColumnIndex};
+            if (secondColumnIndex != -1)
+                predicateColumns.push_back(secondColumnIndex);
+            Page page = bufferManager.getPage(table->tableName, pageCounter, predicateColumns);
+            int rowCount = page.getRowCount();
+            vector<vector<int>> rows;
+            // a run-length or dictionary encoded column is compared run by
+            // run or value by value of its dictionary, without decoding it
+            if (secondColumnIndex != -1 || !page.selectEncoded(firstColumnIndex, selectionMatches, selection))
+            {
+                rows = page.getRows();
+                values1.resize(rowCount);
+                values2.resize(rowCount);
+                for (int rowCounter = 0; rowCounter < rowCount; rowCounter++)
+                {
+                    values1[rowCounter] = rows[rowCounter][firstColumnIndex];
+                    if (secondColumnIndex != -1)
+                        values2[rowCounter] = rows[rowCounter][secondColumnIndex];
+                }
+                if (parsedQuery.selectionInValues.empty())
+                    evaluateBinOpColumn(values1.data(), secondColumnIndex != -1 ? values2.data() : NULL, parsedQuery.selectionIntLiteral, rowCount, parsedQuery.selectionBinaryOperator, selection);
+                else
+                {
+                    selection.assign((rowCount + 63) / 64, 0);
+                    for (int rowCounter = 0; rowCounter < rowCount; rowCounter++)
+                        if (selectionMatches(values1[rowCounter]))
+                            selection[rowCounter >> 6] |= 1ULL << (rowCounter & 63);
+                }
+            }
+
+            // rows deleted but still in the page do not qualify
+            if (pageCounter >= 0 && pageCounter < table->deletedRowsPerBlock.size() && !table->deletedRowsPerBlock[pageCounter].empty())
+                for (int wordCounter = 0; wordCounter < selection.size(); wordCounter++)
+                    selection[wordCounter] &= ~table->deletedRowsPerBlock[pageCounter][wordCounter];
+
+            bool anyQualifies = false;
+            for (uint64_t word : selection)
+                anyQualifies |= word != 0;
+            if (!anyQualifies)
+                continue;
+            if (table->pageLayout == PAX)
+                rows = bufferManager.getPage(table->tableName, pageCounter).getRows();
+
+            // gather the qualifying rows of the page and append them in one write
+            qualifyingRows.clear();
+            for (int wordCounter = 0; wordCounter < selection.size(); wordCounter++)
+            {
+                uint64_t word = selection[wordCounter];
+                while (word)
+                {
+                    qualifyingRows.push_back(rows[wordCounter * 64 + __builtin_ctzll(word)]);
+                    word &= word - 1;
+                }
+            }
+            if (!qualifyingRows.empty())
+                resultantTable->writeRows(qualifyingRows);
         }
     }
     if (resultantTable->blockify())
@@ -27,8 +27,37 @@ bool semanticParseSOURCE()
     return true;
 }
 
+/**
+ * @brief Runs every command of the script, one per line. Their log records
+ * are committed together once the script ends.
+ */
 void executeSOURCE()
 {
     logger.log("executeSOURCE");
+    ifstream fin("../data/" + parsedQuery.sourceFileName + ".ra", ios::in);
+    regex delim("[^\\s,(]+");
+    string command;
+    wal.batchDepth++;
+    while (getline(fin, command))
+    {
+        tokenizedQuery.clear();
+        parsedQuery.clear();
+        auto words_begin = std::sregex_iterator(command.begin(), command.end(), delim);
+        auto words_end = std::sregex_iterator();
+        for (std::sregex_iterator i = words_begin; i != words_end; ++i)
+            tokenizedQuery.emplace_back((*i).str());
+
+        if (tokenizedQuery.size() == 1 && tokenizedQuery.front() == "QUIT")
+            break;
+        if (tokenizedQuery.empty())
+            continue;
+        if (tokenizedQuery.size() == 1)
+        {
+            cout << "SYNTAX ERROR" << endl;
+            continue;
+        }
+        doCommand();
+    }
+    wal.batchDepth--;
     return;
 }
@@ -1,4 +1,4 @@
-#include"executor.h"
+#include"wal.h"
 
 #ifndef PROTECTION
 #define PROTECTION "PLEASE_USE_PROTECTION"
@@ -7,9 +7,13 @@ extern int MAX_ROWS_MATRIX;
 extern int MAX_COLS_MATRIX;
 extern uint BLOCK_COUNT;
 extern uint PRINT_COUNT;
+extern uint THREAD_COUNT;
+extern uint FLUSH_INTERVAL;
+extern float BTREE_FILL_FACTOR;
 extern vector<string> tokenizedQuery;
 extern ParsedQuery parsedQuery;
 extern TableCatalogue tableCatalogue;
 extern MatrixCatalogue matrixCatalogue;
 extern BufferManager bufferManager;
+extern WriteAheadLog wal;
 #endif // !
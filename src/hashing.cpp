@@ -1,267 +1,349 @@
 #include "global.h"
 
+// share of the page slots the entries may fill before a bucket is split
+const float HASH_FILL_FACTOR = 0.8;
+
 hashing::hashing()
 {
     logger.log("hashing::hashing");
 }
 
-// [] -> -> -> -> 
-// [] -> -> -> ->
-// [] -> -> -> -> -> ->
-// [] -> -> -> -> 
-// [] -> -> ->
-// [] ->
+/**
+ * @brief Construct a new, empty hash index. Buckets get their first page when
+ * the first entry lands in them.
+ *
+ * @param tableName
+ * @param b number of buckets to start with
+ * @param rowCount
+ * @param indexedColumnNumber
+ */
+hashing::hashing(string tableName, int b, int rowCount, int indexedColumnNumber)
+{
+    logger.log("hashing::hashing");
+    this->tableName = tableName;
+    this->indexName = tableName + "_Hash" + to_string(indexedColumnNumber);
+    this->initialBuckets = max(1, b);
+    // a page holds as many entries as a table page of 3 columns, less the header
+    this->capacity = max(1, (int)((BLOCK_SIZE * 1000) / (32 * 3)) - 1);
+    this->bucketPages.assign(this->initialBuckets, -1);
+}
 
+/**
+ * @brief Function that returns the bucket of a key. Buckets below the split
+ * pointer have already been split this round and use twice as many buckets.
+ *
+ * @param key
+ * @return uint
+ */
+uint hashing::bucketOf(int key)
+{
+    uint h = (uint)key * 2654435769u;
+    h ^= h >> 16;
+    uint bucket = h % ((uint)this->initialBuckets << this->level);
+    if (bucket < this->next)
+        bucket = h % ((uint)this->initialBuckets << (this->level + 1));
+    return bucket;
+}
 
-hashing::hashing(string tableName, int b,int rowCount, int indexedColumnNumber ) 
-{ 
-    this->BUCKET = b; 
-    this->tableName = tableName;
-    for (int i = 0; i < b; i++)
+/**
+ * @brief Function that hands out the id of an unused page, reusing the pages
+ * freed by splits and deletes first
+ *
+ * @return int
+ */
+int hashing::newPage()
+{
+    if (this->freePages.empty())
+        return this->pageCount++;
+    int pageId = this->freePages.back();
+    this->freePages.pop_back();
+    return pageId;
+}
+
+/**
+ * @brief Function that reads a page of the index, header row first
+ *
+ * @param pageId
+ * @return vector<vector<int>>
+ */
+vector<vector<int>> hashing::readPage(int pageId)
+{
+    Page page = bufferManager.getIndexPage(this->indexName, pageId, 3);
+    return page.getRows();
+}
+
+/**
+ * @brief Function that writes count entries, starting at from, as a page of
+ * the chain of a bucket
+ *
+ * @param pageId
+ * @param nextPage next page of the chain, -1 for the last one
+ * @param bucket
+ * @param entries
+ * @param from
+ * @param count
+ */
+void hashing::writePage(int pageId, int nextPage, int bucket, vector<vector<int>> &entries, int from, int count)
+{
+    vector<vector<int>> rows;
+    rows.reserve(count + 1);
+    rows.push_back({nextPage, count, bucket});
+    rows.insert(rows.end(), entries.begin() + from, entries.begin() + from + count);
+    bufferManager.writeIndexPage(this->indexName, pageId, rows);
+}
+
+/**
+ * @brief Function that reads every entry of a bucket
+ *
+ * @param bucket
+ * @return vector<vector<int>>
+ */
+vector<vector<int>> hashing::readBucket(int bucket)
+{
+    vector<vector<int>> entries;
+    for (int pageId = this->bucketPages[bucket]; pageId != -1;)
     {
-      bt* buk = (bt*) malloc(sizeof(bt));
-      buk->next = NULL;
-      buk->prev = NULL;
-      buk->data = -1;
-      vector <bt*> v;
-      v.push_back(buk);
-      this->bucks.push_back(v);
+        vector<vector<int>> rows = this->readPage(pageId);
+        entries.insert(entries.end(), rows.begin() + 1, rows.end());
+        pageId = rows[0][0];
     }
-    OVERFLOW_SIZE = 2;
-    this->pointerBucket = 0;
-} 
-  
-int sizeOfList(bt * iter){
-  int count = 0;
-  while (iter)
-  {
-    count++;
-    iter = iter->next;
-  }
-  return count;
+    return entries;
 }
 
 /**
- * @brief Function called to reHash the bucket
- * @param key 
- * @return  
+ * @brief Function that replaces the entries of a bucket, packing them into as
+ * few pages as they need. The pages of the old chain are reused and the ones
+ * left over are freed.
+ *
+ * @param bucket
+ * @param entries
  */
-void hashing::reHash(int key){
-  vector < vector< bt* > > temp;
-  for (int i = 0; i < this->bucks.size(); i++)
-  {
-    temp.push_back(this->bucks[i]);
-  }
-  this->bucks.clear();
-  for (int i = 0; i < BUCKET * 2; i++)
-  {
-    bt* buk = (bt*) malloc(sizeof(bt));
-    buk->next = NULL;
-    buk->prev = NULL;
-    buk->data = -1;
-    vector <bt*> v;
-    v.push_back(buk);
-    this->bucks.push_back(v);
-  }
-  for (int i = 0; i < temp.size(); i++)
-  {
-    for (int j = 1; j < temp[i].size(); j++)
-    { 
-      // aifsn 
-      int kkey = (temp[i][j]->data) % (2 * BUCKET);
-      this->bucks[kkey].push_back(temp[i][j]);
+void hashing::writeBucket(int bucket, vector<vector<int>> &entries)
+{
+    vector<int> chain;
+    for (int pageId = this->bucketPages[bucket]; pageId != -1; pageId = this->readPage(pageId)[0][0])
+        chain.push_back(pageId);
+    int needed = (entries.size() + this->capacity - 1) / this->capacity;
+    while (chain.size() < needed)
+        chain.push_back(this->newPage());
+    while (chain.size() > needed)
+    {
+        this->freePages.push_back(chain.back());
+        chain.pop_back();
+    }
+    for (int pageCounter = 0; pageCounter < needed; pageCounter++)
+    {
+        int from = pageCounter * this->capacity;
+        int nextPage = pageCounter + 1 < needed ? chain[pageCounter + 1] : -1;
+        this->writePage(chain[pageCounter], nextPage, bucket, entries, from, min(this->capacity, (int)entries.size() - from));
     }
-  }
-  this->pointerBucket = 0;
+    this->bucketPages[bucket] = needed ? chain[0] : -1;
 }
 
 /**
- * @brief Function called to insert item into Hash
+ * @brief Function that splits the bucket under the split pointer. Its entries
+ * are rehashed modulo twice as many buckets: they either stay or move to the
+ * new bucket at the end.
+ */
+void hashing::split()
+{
+    logger.log("hashing::split");
+    int bucket = this->next;
+    vector<vector<int>> entries = this->readBucket(bucket);
+    this->bucketPages.push_back(-1);
+    this->next++;
+    if (this->next == (this->initialBuckets << this->level))
+    {
+        // every bucket of the round has been split
+        this->level++;
+        this->next = 0;
+    }
+    vector<vector<int>> staying, moving;
+    for (auto &entry : entries)
+    {
+        if (this->bucketOf(entry[0]) == bucket)
+            staying.push_back(entry);
+        else
+            moving.push_back(entry);
+    }
+    this->writeBucket(bucket, staying);
+    this->writeBucket(this->bucketPages.size() - 1, moving);
+}
+
+/**
+ * @brief Function called to insert item into Hash. The entry goes to the
+ * first page of the chain of its bucket with room, or to a new page at the
+ * end of the chain.
+ *
  * @param key
  * @param pagePtr
  * @param rowPtr
- * @return  
+ * @return
  */
-void hashing::insertItem(int key, int pagePtr, int rowPtr) 
+void hashing::insertItem(int key, int pagePtr, int rowPtr)
 {
-    bt* item = (bt*) malloc(sizeof(bt));
-    item->data = key;
-    item->pagePtr = pagePtr;
-    item->rowPtr = rowPtr;
-    item->next = NULL;
-    int OVERFLOW_SIZE = 2;
-    int index = hashFunction(key);
-    item->prev = NULL;
-    int siz = bucks[index].size();
-    if(index < this->pointerBucket){
-      // these buckets are split, use the new hash function
-      index = hashFunction2(key);
-      if(this->bucks.size() > index){
-        this->bucks[index].push_back(item);
-      }
-      siz = this->bucks[index].size();
-    }
-    else{
-      if(this->bucks.size() > index){
-        this->bucks[index].push_back(item);
-      }      
-      siz = bucks[index].size();
+    uint bucket = this->bucketOf(key);
+    vector<vector<int>> entry = {{key, pagePtr, rowPtr}};
+    int pageId = this->bucketPages[bucket];
+    if (pageId == -1)
+    {
+        pageId = this->newPage();
+        this->bucketPages[bucket] = pageId;
+        this->writePage(pageId, -1, bucket, entry, 0, 1);
     }
-
-    
-
-    if(siz > OVERFLOW_SIZE){
-      // break the pointerBucket
-      bt* buk = (bt*) malloc(sizeof(bt));
-      buk->next = NULL;
-      buk->prev = NULL;
-      buk->data = -1;
-      vector <bt*> v;
-      v.push_back(buk);
-      this->bucks.push_back(v);
-      vector <bt*> a1;
-      vector <bt*> a2;
-      a1.push_back(buk);
-      a2.push_back(buk);
-      // iterate from overflow to end and move this to end 
-      // k % BUCKET == k % 2*BUCKET;
-      for (int i = 1; i < this->bucks[this->pointerBucket].size(); i++)
-      {
-        int kkey = hashFunction2(this->bucks[this->pointerBucket][i]->data);
-        int aa = 1;
-        // cout << this->bucks[this->pointerBucket][i]->data <<  "][" << hashFunction2(this->bucks[this->pointerBucket][i]->data) <<  endl;
-        if(kkey == hashFunction(this->bucks[this->pointerBucket][i]->data))
+    else
+    {
+        vector<vector<int>> rows = this->readPage(pageId);
+        while (rows[0][1] >= this->capacity && rows[0][0] != -1)
+        {
+            pageId = rows[0][0];
+            rows = this->readPage(pageId);
+        }
+        if (rows[0][1] >= this->capacity)
         {
-          a1.push_back(this->bucks[this->pointerBucket][i]);
+            // chain full, add an overflow page
+            int overflowPage = this->newPage();
+            rows[0][0] = overflowPage;
+            bufferManager.writeIndexPage(this->indexName, pageId, rows);
+            this->writePage(overflowPage, -1, bucket, entry, 0, 1);
         }
         else
         {
-          a2.push_back(this->bucks[this->pointerBucket][i]);
+            rows.push_back(entry[0]);
+            rows[0][1]++;
+            bufferManager.writeIndexPage(this->indexName, pageId, rows);
         }
-      }
-      this->bucks[this->pointerBucket] = a1;
-      this->bucks[this->pointerBucket+BUCKET] = a2;
-      this->pointerBucket++;
-
-      if(this->pointerBucket == BUCKET ){
-        // last bucket has been broken
-        // reHash everything
-        this->reHash(BUCKET);
-        BUCKET *= 2;
-      }
     }
-} 
-  
+    this->entryCount++;
+    if (this->entryCount > HASH_FILL_FACTOR * this->capacity * this->bucketPages.size())
+        this->split();
+}
 
 /**
- * @brief Function called to delete internally from Hash
+ * @brief Function called to delete item from Hash. The last entry of the page
+ * takes the place of the deleted one, and a page left empty is unlinked from
+ * its chain.
+ *
  * @param key
  * @param pagePtr
  * @param rowPtr
  * @return bool
- */  
-bool hashing::deleteItem(int key, int pagePtr, int rowPtr) 
+ */
+bool hashing::deleteItem(int key, int pagePtr, int rowPtr)
 {
-  // [0]8, 16, 24
-  // [1]9,17, 25
-  // [2]erwetre ,ewr,e esh 
-  // [3],ewr sg eh 
-  // [4]sfd,g, e s,,g 
-  // [5] 3,4,5,
-  // [6] 
-  // [7] 1
-
-
-  // get the hash index of key 
-  int index = hashFunction(key); 
-  if(index < this->pointerBucket){
-    index = hashFunction2(key);
-  }
-  int found = 0;
-  int where = 0;
-  for (int i = 1; i < this->bucks[index].size(); i++)
-  {
-    if(this->bucks[index][i]->data == key && this->bucks[index][i]->pagePtr == pagePtr && this->bucks[index][i]->rowPtr == rowPtr){
-      // delete this item
-      found = 1;
-      where = i;
-    }
-  }
-  if(found){
-    // found it, delete at the position
-    this->bucks[index].erase(this->bucks[index].begin() + where);
-
-    // deleting stuff
-
-    int ind = index;
-    if(ind == (this->pointerBucket + BUCKET) ){
-      while (this->bucks[ind].size() == 1)
-      {
-        // this->bucks.erase(this->bucks.start() + ind)
-        ind--;
-      }
+    uint bucket = this->bucketOf(key);
+    int previousPage = -1;
+    for (int pageId = this->bucketPages[bucket]; pageId != -1;)
+    {
+        vector<vector<int>> rows = this->readPage(pageId);
+        for (int rowCounter = 1; rowCounter < rows.size(); rowCounter++)
+        {
+            if (rows[rowCounter][0] != key || rows[rowCounter][1] != pagePtr || rows[rowCounter][2] != rowPtr)
+                continue;
+            rows[rowCounter] = rows.back();
+            rows.pop_back();
+            rows[0][1]--;
+            if (rows[0][1] > 0)
+                bufferManager.writeIndexPage(this->indexName, pageId, rows);
+            else
+            {
+                if (previousPage == -1)
+                    this->bucketPages[bucket] = rows[0][0];
+                else
+                {
+                    vector<vector<int>> previousRows = this->readPage(previousPage);
+                    previousRows[0][0] = rows[0][0];
+                    bufferManager.writeIndexPage(this->indexName, previousPage, previousRows);
+                }
+                this->freePages.push_back(pageId);
+            }
+            this->entryCount--;
+            return true;
+        }
+        previousPage = pageId;
+        pageId = rows[0][0];
     }
-
-    return true;
-  }
-  else{
-    // not found, kya hi kar sakte hai
     return false;
-  }
-} 
-  
-// function to display hash table 
+}
+
 /**
  * @brief Function called to search in Hash
  * @param key
- * @return vector of data pointers
+ * @return locations of every row holding the key, empty if there is none
  */
-vector<pair<int,int>> hashing::searchElement(int key) {
-  vector<pair<int,int>> ret;
-  int found = 1;
-  int index = hashFunction(key);
-  // cout << index << "\tLADIOAFION" << endl;
-  if(index < this->pointerBucket){
-    index = hashFunction2(key);
-    // cout << index << "\tLADIOAFION" << endl;
-  }
-  // cout << index << "\t Search here" << endl;
-  // cout << this->pointerBucket << endl;
-  // cout << BUCKET << endl;
-  // cout << this->bucks[index].size() << endl;;
-  for (int i = 1; i < this->bucks[index].size(); i++) { 
-    cout << "||" << this->bucks[index][i]->data << "||" << endl;
-    if(this->bucks[index][i]->data == key){
-        found = 1;
-        cout << "FOUND" << endl;
-        cout << this->bucks[index][i]->rowPtr << endl;
-        ret.push_back({this->bucks[index][i]->pagePtr,this->bucks[index][i]->rowPtr});
+vector<pair<int,int>> hashing::searchElement(int key)
+{
+    vector<pair<int,int>> ret;
+    if (this->bucketPages.empty())
+        return ret;
+    for (int pageId = this->bucketPages[this->bucketOf(key)]; pageId != -1;)
+    {
+        vector<vector<int>> rows = this->readPage(pageId);
+        for (int rowCounter = 1; rowCounter < rows.size(); rowCounter++)
+            if (rows[rowCounter][0] == key)
+                ret.push_back({rows[rowCounter][1], rows[rowCounter][2]});
+        pageId = rows[0][0];
     }
-  }
-  bt* nod = (bt*) malloc(sizeof(bt));
-  nod->prev = NULL;
-  nod->next = NULL;
-  nod->data = -1;
-  if(!found){
-    ret.push_back({-2,-2});
-  }
-  return ret;
+    return ret;
+}
+
+/**
+ * @brief Function called to queue an entry for bulkBuild
+ *
+ * @param key
+ * @param pagePtr
+ * @param rowPtr
+ */
+void hashing::bulkInsert(int key, int pagePtr, int rowPtr)
+{
+    this->bulkEntries.push_back({key, pagePtr, rowPtr});
+}
+
+/**
+ * @brief Function called to build an empty index from the queued entries.
+ * The number of buckets is chosen up front for the fill factor, so nothing is
+ * split, and every page is written once.
+ */
+void hashing::bulkBuild()
+{
+    logger.log("hashing::bulkBuild");
+    int buckets = max(this->initialBuckets, (int)ceil(this->bulkEntries.size() / (HASH_FILL_FACTOR * this->capacity)));
+    this->level = 0;
+    while ((this->initialBuckets << (this->level + 1)) <= buckets)
+        this->level++;
+    this->next = buckets - (this->initialBuckets << this->level);
+    this->bucketPages.assign(buckets, -1);
+    vector<vector<vector<int>>> partitions(buckets);
+    for (auto &entry : this->bulkEntries)
+        partitions[this->bucketOf(entry[0])].push_back(entry);
+    for (int bucket = 0; bucket < buckets; bucket++)
+        if (!partitions[bucket].empty())
+            this->writeBucket(bucket, partitions[bucket]);
+    this->entryCount += this->bulkEntries.size();
+    vector<vector<int>>().swap(this->bulkEntries);
 }
 
-// function to display hash table 
 /**
  * @brief Function called to display hash structure
- * @return  
+ * @return
  */
-void hashing::displayHash() { 
-  for (int i = 0; i < this->bucks.size(); i++) { 
-    if(i == this->pointerBucket){
-      cout << ">>" ;
-    }
-    for (int j = 0; j < this->bucks[i].size(); j++)
-    {
-      cout << "|" << this->bucks[i][j]->data << "|" ;
-    }
-    cout << endl;
-  }
-} 
\ No newline at end of file
+void hashing::displayHash()
+{
+    cout << "Hash index " << this->indexName << ": " << this->entryCount << " entries in " << this->bucketPages.size() << " buckets, " << this->pageCount - this->freePages.size() << " pages" << endl;
+}
+
+/**
+ * @brief Function called to delete every page of the index
+ */
+void hashing::drop()
+{
+    if (this->indexName == "")
+        return;
+    bufferManager.deleteIndex(this->indexName, this->pageCount);
+    this->level = 0;
+    this->next = 0;
+    this->pageCount = 0;
+    this->entryCount = 0;
+    this->bucketPages.assign(this->initialBuckets, -1);
+    this->freePages.clear();
+}
@@ -1,72 +1,66 @@
 
 /**
- * @brief The BufferManager is responsible for reading pages to the main memory.
- * Recall that large files are broken and stored as blocks in the hard disk. The
- * minimum amount of memory that can be read from the disk is a block whose size
- * is indicated by BLOCK_SIZE. within this system we simulate blocks by
- * splitting and storing the file as multiple files each of one BLOCK_SIZE,
- * although this isn't traditionally how it's done. You can alternatively just
- * random access to the point where a block begins within the same
- * file. In this system we assume that the the sizes of blocks and pages are the
- * same. 
- * 
+ * @brief The hashing class is the hash index of a table column. It maps every
+ * value of the column to the locations (page, row) of the rows holding it,
+ * one entry per row.
+ *
+ * <p>
+ * The index is a linear hash kept in index pages, named
+ * "<tablename>_Hash<column>_Page<pageid>", that are read and written through
+ * the BufferManager like the nodes of a bplusTree. Every bucket is a chain of
+ * pages: the first row of a page is {next page of the chain or -1, number of
+ * entries, bucket} and every other row is an entry {key, pagePtr, rowPtr}.
+ * A lookup reads the chain of one bucket, usually a single page.
+ * </p>
+ *
  * <p>
- * The buffer can hold multiple pages quantified by BLOCK_COUNT. The
- * buffer manager follows the FIFO replacement policy i.e. the first block to be
- * read in is replaced by the new incoming block. This replacement policy should
- * be transparent to the executors i.e. the executor should not know if a block
- * was previously present in the buffer or was read in from the disk. 
+ * The index starts with the given number of buckets N. When the entries fill
+ * more than HASH_FILL_FACTOR of the pages, the bucket under the split pointer
+ * is split in two by rehashing it modulo twice as many buckets, and the
+ * pointer moves on; once every bucket of the round has been split the number
+ * of buckets has doubled and the next round starts. So the index grows a
+ * bucket at a time and no insert rehashes more than one bucket.
  * </p>
  *
  */
-typedef struct bucket{
-    int data;
-    string tableName; // which table it belongs to
-    int pagePtr; // which page it belongs to
-    int rowPtr;  // which row it belongs to within the page
-    struct bucket* next;
-    struct bucket* prev;
-}bt;
+class hashing
+{
+    int initialBuckets = 1;
+    int level = 0;
+    int next = 0; // split pointer
+    int capacity = 0; // entries per page
+    int pageCount = 0;
+    int entryCount = 0;
+    vector<int> bucketPages; // first page of every bucket, -1 if empty
+    vector<int> freePages;
+    vector<vector<int>> bulkEntries;
 
-  
-class hashing 
-{ 
-    
-public: 
-    int BUCKET;    // No. of buckets 
-  
-    // Pointer to an array containing buckets 
-    vector < vector< bt* > > bucks; 
-    vector < vector <bt*> > over;
-    int pointerBucket;
-    int OVERFLOW_SIZE;
-    string tableName;
+    uint bucketOf(int key);
+    int newPage();
+    vector<vector<int>> readPage(int pageId);
+    void writePage(int pageId, int nextPage, int bucket, vector<vector<int>> &entries, int from, int count);
+    vector<vector<int>> readBucket(int bucket);
+    void writeBucket(int bucket, vector<vector<int>> &entries);
+    void split();
 
-    // inserts a key into hash table 
-    void insertItem(int key, int pagePtr, int rowPtr);
-  
-    // searches a key into hash table 
-    vector<pair<int,int>> searchElement(int key);
-
-    // deletes a key from hash table 
-    bool deleteItem(int key, int pagePtr, int rowPtr); 
-  
-    // hash function to map values to key 
-    int hashFunction(int x) { 
-        return (x % BUCKET); 
-    } 
+public:
+    string tableName;
+    string indexName;
 
-    // hash function to map values to key 
-    int hashFunction2(int x) { 
-        return (x % (2 * BUCKET)); 
-    } 
+    hashing();
+    hashing(string tableName, int b, int rowCount, int indexedColumnNumber);
 
+    // inserts a key into hash table
+    void insertItem(int key, int pagePtr, int rowPtr);
 
-    void reHash(int key);
+    // searches a key into hash table
+    vector<pair<int,int>> searchElement(int key);
 
-    hashing();
-    hashing(string tableName, int b,int rowCount, int indexedColumnNumber );
-    
+    // deletes a key from hash table
+    bool deleteItem(int key, int pagePtr, int rowPtr);
 
-    void displayHash(); 
-}; 
+    void bulkInsert(int key, int pagePtr, int rowPtr);
+    void bulkBuild();
+    void displayHash();
+    void drop();
+};
@@ -10,6 +10,7 @@ class Logger{
 
     string logFile = "log";
     ofstream fout;
+    mutex logMutex;
     
     public:
 
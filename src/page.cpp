@@ -1,4 +1,9 @@
 #include "global.h"
+
+// starts the header line of a page file in the PAX layout, followed by the
+// offsets of the minipages
+const char PAX_PAGE_MARKER[] = "PAX";
+
 /**
  * @brief Construct a new Page object. Never used as part of the code
  *
@@ -33,29 +38,8 @@ Page::Page(string tableName, int pageIndex)
     this->pageName = "../data/temp/" + tableName + "_Page" + to_string(pageIndex);
     logger.log(this->pageName);
     if (tableCatalogue.isTable(tableName)){
-        // cout << "arey  table hai re baba " << endl;
         // it is table
-        Table table = *tableCatalogue.getTable(tableName);
-        this->tableName = tableName;
-        this->columnCount = table.columnCount;
-        uint maxRowCount = table.maxRowsPerBlock;
-        vector<int> row(columnCount, 0);
-        this->rows.assign(maxRowCount, row);
-
-        ifstream fin(pageName, ios::in);
-        // cout << "in page now: ";
-        // cout << "page index is "<< pageIndex << "     " << "rows in page is :: "<<  table.rowsPerBlockCount[pageIndex]  <<endl;
-        this->rowCount = table.rowsPerBlockCount[pageIndex];
-        int number;
-        for (uint rowCounter = 0; rowCounter < this->rowCount; rowCounter++)
-        {
-            for (int columnCounter = 0; columnCounter < columnCount; columnCounter++)
-            {
-                fin >> number;
-                this->rows[rowCounter][columnCounter] = number;
-            }
-        }
-        fin.close();
+        this->readTablePage(*tableCatalogue.getTable(tableName), pageIndex, {});
     }
     else if (matrixCatalogue.isMatrix(tableName)){
         // it is a matrix
@@ -91,6 +75,143 @@ Page::Page(string tableName, int pageIndex)
     }
 }
 
+/**
+ * @brief Construct a new Page object holding only some columns of a page of
+ * a table, the others reading 0. Of a PAX page only the minipages of those
+ * columns are read; a ROW_MAJOR page is read whole.
+ *
+ * @param tableName 
+ * @param pageIndex 
+ * @param columnIndices 
+ */
+Page::Page(string tableName, int pageIndex, vector<int> columnIndices)
+{
+    logger.log("Page::Page4");
+    this->pageIndex = pageIndex;
+    this->pageName = "../data/temp/" + tableName + "_Page" + to_string(pageIndex);
+    this->readTablePage(*tableCatalogue.getTable(tableName), pageIndex, columnIndices);
+}
+
+/**
+ * @brief Reads the rows of a page of the table from its file, in whichever
+ * layout the file was written. Columns added by ALTER after the page was
+ * written take their defaults.
+ *
+ * @param table 
+ * @param pageIndex 
+ * @param columnIndices columns to read, all of them if empty
+ */
+void Page::readTablePage(Table &table, int pageIndex, vector<int> columnIndices)
+{
+    this->tableName = table.tableName;
+    this->columnCount = table.columnCount;
+    this->layout = table.pageLayout;
+    vector<int> row(columnCount, 0);
+    this->rows.assign(table.maxRowsPerBlock, row);
+    // pages below 0 are the delta store of a BTREE indexed table
+    this->rowCount = table.getPageRowCount(pageIndex);
+    int firstLazyColumn = columnCount - table.lazyColumnDefaults.size();
+    int number;
+
+    ifstream fin(pageName, ios::in | ios::binary);
+    if (fin.peek() == PAX_PAGE_MARKER[0])
+    {
+        string header, marker;
+        getline(fin, header);
+        stringstream offsets(header);
+        offsets >> marker;
+        vector<long long> columnOffsets;
+        long long offset;
+        while (offsets >> offset)
+            columnOffsets.push_back(offset);
+        streampos minipagesStart = fin.tellg();
+        fin.seekg(0, ios::end);
+        columnOffsets.push_back(fin.tellg() - minipagesStart);
+
+        bool wholePage = columnIndices.empty();
+        if (wholePage)
+            for (int columnCounter = 0; columnCounter < columnCount; columnCounter++)
+                columnIndices.push_back(columnCounter);
+        for (int columnCounter : columnIndices)
+        {
+            if (columnCounter + 1 >= columnOffsets.size())
+            {
+                for (uint rowCounter = 0; rowCounter < this->rowCount; rowCounter++)
+                    this->rows[rowCounter][columnCounter] = table.lazyColumnDefaults[columnCounter - firstLazyColumn];
+                continue;
+            }
+            string &minipage = this->encodedColumns[columnCounter];
+            minipage.resize(columnOffsets[columnCounter + 1] - columnOffsets[columnCounter]);
+            fin.seekg(minipagesStart + (streamoff)columnOffsets[columnCounter]);
+            fin.read(&minipage[0], minipage.size());
+        }
+        // a page read for some columns is decoded once its rows are asked
+        // for, a predicate may be answered from the encoded columns first
+        if (wholePage)
+            this->decodeColumns();
+    }
+    else if (table.lazyColumnDefaults.empty())
+    {
+        for (uint rowCounter = 0; rowCounter < this->rowCount; rowCounter++)
+        {
+            for (int columnCounter = 0; columnCounter < columnCount; columnCounter++)
+            {
+                fin >> number;
+                this->rows[rowCounter][columnCounter] = number;
+            }
+        }
+    }
+    else
+    {
+        // a row written before ALTER added the last columns ends short of
+        // them, they take their defaults
+        string line;
+        for (uint rowCounter = 0; rowCounter < this->rowCount && getline(fin, line); rowCounter++)
+        {
+            stringstream values(line);
+            int columnCounter = 0;
+            while (columnCounter < columnCount && values >> number)
+                this->rows[rowCounter][columnCounter++] = number;
+            for (columnCounter = max(columnCounter, firstLazyColumn); columnCounter < columnCount; columnCounter++)
+                this->rows[rowCounter][columnCounter] = table.lazyColumnDefaults[columnCounter - firstLazyColumn];
+        }
+    }
+    fin.close();
+}
+
+/**
+ * @brief Decodes the minipages read from a PAX page into its rows
+ */
+void Page::decodeColumns()
+{
+    vector<int> values;
+    for (auto &minipage : this->encodedColumns)
+    {
+        decodeColumn(minipage.second, this->rowCount, values);
+        for (int rowCounter = 0; rowCounter < this->rowCount; rowCounter++)
+            this->rows[rowCounter][minipage.first] = values[rowCounter];
+    }
+    this->encodedColumns.clear();
+}
+
+/**
+ * @brief Evaluates a predicate on a column of the page before it is decoded,
+ * if the encoding of its minipage allows
+ *
+ * @param columnIndex 
+ * @param matches the predicate
+ * @param selection out: the rows that satisfy it, as a bitmap
+ * @return false if the rows have to be read instead
+ */
+bool Page::selectEncoded(int columnIndex, function<bool(int)> matches, vector<uint64_t> &selection)
+{
+    logger.log("Page::selectEncoded");
+    auto minipage = this->encodedColumns.find(columnIndex);
+    if (minipage == this->encodedColumns.end())
+        return false;
+    return selectEncodedColumn(minipage->second, this->rowCount, matches, selection);
+}
+
 /**
  * @brief Get row from page indexed by rowIndex
  * 
@@ -100,6 +221,8 @@ Page::Page(string tableName, int pageIndex)
 vector<int> Page::getRow(int rowIndex)
 {
     logger.log("Page::getRow");
+    if (!this->encodedColumns.empty())
+        this->decodeColumns();
     // cout << "Page " << this->pageName << " Row" << rowIndex << " ";
     vector<int> result;
     result.clear();
@@ -122,6 +245,8 @@ vector<int> Page::getRow(int rowIndex)
 vector< vector<int> > Page::getRows()
 {
     logger.log("Page::getRow");
+    if (!this->encodedColumns.empty())
+        this->decodeColumns();
     return this->rows;
 }
 
@@ -151,7 +276,8 @@ int Page::writeRows(vector <vector<int>> tows,int rowCount)
 
 
 /**
- * @brief Insert row into rows
+ * @brief Insert row into rows. Only the page in memory changes, writing it is
+ * left to the caller
  * 
  * @param 2D vector of rows
  * @return inrt
@@ -161,18 +287,18 @@ void Page::insertPageRow(vector<int> values ){
     // for (auto x: values){
     //     cout << x;
     // }
-    for (int i=0;i<values.size();i++)
-    {
-        this->rows[this->rowCount][i]= values[i];
-    }
+    // a delete leaves no spare slot behind
+    if (this->rowCount < this->rows.size())
+        this->rows[this->rowCount] = values;
+    else
+        this->rows.push_back(values);
     this->rowCount++;
-
-    this->writePage();
 }
 
-Page::Page(string tableName, int pageIndex, vector<vector<int>> rows, int rowCount)
+Page::Page(string tableName, int pageIndex, vector<vector<int>> rows, int rowCount, PageLayout layout)
 {
     logger.log("Page::Page2");
+    this->layout = layout;
     this->MatrixName = tableName; // matrix
     this->tableName = tableName; // table
     this->pageIndex = pageIndex;
@@ -183,6 +309,34 @@ Page::Page(string tableName, int pageIndex, vector<vector<int>> rows, int rowCou
     logger.log(this->pageName);
 }
 
+/**
+ * @brief Construct a new Page object for a page of an index. Index pages are
+ * not described by the table catalogue, so every line of the file is read as
+ * a row of columnCount integers.
+ *
+ * @param indexName 
+ * @param pageIndex 
+ * @param columnCount 
+ */
+Page::Page(string indexName, int pageIndex, int columnCount)
+{
+    logger.log("Page::Page3");
+    this->tableName = indexName;
+    this->pageIndex = pageIndex;
+    this->columnCount = columnCount;
+    this->pageName = "../data/temp/" + indexName + "_Page" + to_string(pageIndex);
+    ifstream fin(this->pageName, ios::in);
+    vector<int> row(columnCount, 0);
+    while (fin >> row[0])
+    {
+        for (int columnCounter = 1; columnCounter < columnCount; columnCounter++)
+            fin >> row[columnCounter];
+        this->rows.push_back(row);
+    }
+    this->rowCount = this->rows.size();
+    fin.close();
+}
+
 /**
  * @brief writes current page contents to file.
  * 
@@ -191,7 +345,32 @@ void Page::writePage()
 {
     logger.log("Page::writePage");
     // cout << "RAndom cheez"<<endl;
-    ofstream fout(this->pageName, ios::trunc);
+    ofstream fout(this->pageName, ios::trunc | ios::binary);
+    if (this->layout == PAX)
+    {
+        // every column is encoded on its own, see columnEncoding.h
+        vector<string> minipages(this->columnCount);
+        vector<int> values(this->rowCount);
+        for (int columnCounter = 0; columnCounter < this->columnCount; columnCounter++)
+        {
+            for (int rowCounter = 0; rowCounter < this->rowCount; rowCounter++)
+                values[rowCounter] = this->rows[rowCounter][columnCounter];
+            minipages[columnCounter] = encodeColumn(values);
+        }
+        // the offsets count from the end of the header line
+        fout << PAX_PAGE_MARKER;
+        long long offset = 0;
+        for (string &minipage : minipages)
+        {
+            fout << " " << offset;
+            offset += minipage.size();
+        }
+        fout << "\n";
+        for (string &minipage : minipages)
+            fout << minipage;
+        fout.close();
+        return;
+    }
     for (int rowCounter = 0; rowCounter < this->rowCount; rowCounter++)
     {
         logger.log(to_string(rowCounter));
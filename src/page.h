@@ -1,4 +1,21 @@
 #include"logger.h"
+#include"columnEncoding.h"
+
+/**
+ * @brief How the rows of a table are laid out in its page files. A ROW_MAJOR
+ * page holds a line per row. A PAX page holds a minipage per column, the
+ * values of the column in every row encoded as in columnEncoding.h, after a
+ * header line giving the offset of each, so that a scan of a few columns
+ * reads only their minipages.
+ */
+enum PageLayout
+{
+    ROW_MAJOR,
+    PAX
+};
+
+class Table;
+
 /**
  * @brief The Page object is the main memory representation of a physical page
  * (equivalent to a block). The page class and the page.h header file are at the
@@ -18,15 +35,23 @@ class Page{
     int columnCount;
     int rowCount;
     vector<vector<int>> rows;
+    // minipages of a PAX page read but not decoded yet, by column
+    unordered_map<int, string> encodedColumns;
+    void readTablePage(Table &table, int pageIndex, vector<int> columnIndices);
+    void decodeColumns();
 
     public:
 
     string pageName = "";
+    PageLayout layout = ROW_MAJOR;
     Page();
     Page(string tableName, int pageIndex);
-    Page(string tableName, int pageIndex, vector<vector<int>> rows, int rowCount);
+    Page(string tableName, int pageIndex, vector<int> columnIndices);
+    Page(string tableName, int pageIndex, vector<vector<int>> rows, int rowCount, PageLayout layout = ROW_MAJOR);
+    Page(string indexName, int pageIndex, int columnCount);
     vector<int> getRow(int rowIndex);
     vector< vector<int> > getRows();
+    bool selectEncoded(int columnIndex, function<bool(int)> matches, vector<uint64_t> &selection);
     int writeRows(vector <vector<int>> tows, int RowCount);
     void writePage();
     int getRowCount();
@@ -6,20 +6,33 @@ using namespace std;
 float BLOCK_SIZE = 8;
 uint BLOCK_COUNT = 16;
 uint PRINT_COUNT = 20;
+uint THREAD_COUNT = 4;
+uint FLUSH_INTERVAL = 100;
+float BTREE_FILL_FACTOR = 0.9;
 int MAX_ROWS_MATRIX = 32;
 int MAX_COLS_MATRIX = 32;
 Logger logger;
+// recovers the log before any table is loaded
+WriteAheadLog wal;
 vector<string> tokenizedQuery;
 ParsedQuery parsedQuery;
+// destroyed after the catalogues, which unload their pages through it
+BufferManager bufferManager;
 TableCatalogue tableCatalogue;
 MatrixCatalogue matrixCatalogue;
-BufferManager bufferManager;
 
 void doCommand()
 {
     logger.log("doCommand");
+    // a merge left running by the last command finishes first
+    tableCatalogue.waitForMerge();
     if (syntacticParse() && semanticParse())
+    {
         executeCommand();
+        // the statements of a SOURCE script commit together at its end
+        if (!wal.batchDepth)
+            wal.commit();
+    }
     return;
 }
 
@@ -114,6 +114,7 @@ void ParsedQuery::clear()
     this->joinSecondColumnName = "";
 
     this->loadRelationName = "";
+    this->loadPageLayout = ROW_MAJOR;
 
     this->printRelationName = "";
 
@@ -132,6 +133,7 @@ void ParsedQuery::clear()
     this->selectionFirstColumnName = "";
     this->selectionSecondColumnName = "";
     this->selectionIntLiteral = 0;
+    this->selectionInValues.clear();
 
     this->sortingStrategy = NO_SORT_CLAUSE;
     this->sortResultRelationName = "";
@@ -143,20 +145,24 @@ void ParsedQuery::clear()
     this->alterRelationName = "";
     this->alterColumnName = "";
     this->alterOperation = "";
+    this->alterDefaultValue = 0;
 
 
 
     this->groupResultRelationName = "";
     this->groupRelationName = "";
     this->groupColumnName = "";
-    this->groupOperationName = "";
-    this->groupOperationColumn = "";
+    this->groupOperationNames.clear();
+    this->groupOperationColumns.clear();
 
     this->sourceFileName = "";
 
     this->insertRelationName = "";
 
     this->deleteRelationName = "";
+    this->deleteColumnName = "";
+    this->deleteBinaryOperator = NO_BINOP_CLAUSE;
+    this->deleteIntLiteral = 0;
 
 
 }
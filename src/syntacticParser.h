@@ -85,6 +85,7 @@ public:
     string joinSecondColumnName = "";
 
     string loadRelationName = "";
+    PageLayout loadPageLayout = ROW_MAJOR;
     string loadMatrixRelationName = "";
 
     string printRelationName = "";
@@ -104,6 +105,7 @@ public:
     string selectionFirstColumnName = "";
     string selectionSecondColumnName = "";
     int selectionIntLiteral = 0;
+    vector<int> selectionInValues; // sorted, empty unless the predicate is IN
 
     SortingStrategy sortingStrategy = NO_SORT_CLAUSE;
     string sortResultRelationName = "";
@@ -123,16 +125,22 @@ public:
 
     string deleteRelationName = "";
     vector<int> deleteValues; 
+    // DELETE ... WHERE, deleteColumnName is empty for DELETE ... VALUES
+    string deleteColumnName = "";
+    BinaryOperator deleteBinaryOperator = NO_BINOP_CLAUSE;
+    int deleteIntLiteral = 0;
 
     string groupResultRelationName = "";
     string groupRelationName = "";
     string groupColumnName = "";
-    string groupOperationName = "";
-    string groupOperationColumn = "";
+    vector<string> groupOperationNames;
+    vector<string> groupOperationColumns;
 
     string alterRelationName = "";
     string alterColumnName = "";
     string alterOperation = "";
+    // value of an added column in the rows already in the table
+    int alterDefaultValue = 0;
 
     string bulkInsertRelationName = "";
     string bulkFromRelationName = "";
@@ -155,6 +163,7 @@ bool syntacticParsePRINT();
 bool syntacticParsePROJECTION();
 bool syntacticParseRENAME();
 bool syntacticParseSELECTION();
+bool syntacticParseSELECTIONIN();
 bool syntacticParseSORT();
 bool syntacticParseSOURCE();
 bool syntacticParseTRANSPOSE();
@@ -162,6 +171,7 @@ bool syntacticParseINSERT();
 bool syntacticParseBULK_INSERT();
 bool syntacticParseGROUP();
 bool syntacticParseDELETE();
+bool syntacticParseDELETEWHERE();
 bool syntacticParseALTER();
 bool syntacticParseLOADMATRIX();
 bool syntacticParseEXPORTMATRIX();
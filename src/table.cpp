@@ -1,5 +1,14 @@
 #include "global.h"
 #include <cstdio>
+
+// share of the rows of a page that may be deleted before it is compacted
+const float COMPACTION_THRESHOLD = 0.25;
+// runs of a level of the delta store merged into one of the next level
+const uint DELTA_RUNS_PER_LEVEL = 4;
+// share of the rows of the pages the delta store grows to before it is merged
+// into them
+const float DELTA_MERGE_RATIO = 0.25;
+
 /**
  * @brief Construct a new Table:: Table object
  *
@@ -145,10 +154,11 @@ bool Table::blockify()
         }
         pageCounter++;
         this->updateStatistics(row);
+        this->updateZoneMap(this->blockCount, row);
         if (pageCounter == this->maxRowsPerBlock)
         {
             // cout << "in blockify ZERO ROWS HERE : " << pageCounter << endl;
-            bufferManager.writePage(this->tableName, this->blockCount, rowsInPage, pageCounter);
+            bufferManager.writePage(this->tableName, this->blockCount, rowsInPage, pageCounter, this->pageLayout);
             this->blockCount++;
             this->rowsPerBlockCount.emplace_back(pageCounter);
             pageCounter = 0;
@@ -158,7 +168,7 @@ bool Table::blockify()
     // cout << "in blockify second loop over" << endl;
     if (pageCounter)
     {
-        bufferManager.writePage(this->tableName, this->blockCount, rowsInPage, pageCounter);
+        bufferManager.writePage(this->tableName, this->blockCount, rowsInPage, pageCounter, this->pageLayout);
         this->blockCount++;
         this->rowsPerBlockCount.emplace_back(pageCounter);
         pageCounter = 0;
@@ -191,6 +201,29 @@ void Table::updateStatistics(vector<int> row)
     }
 }
 
+/**
+ * @brief Widens the per-column min/max range (zone map) kept for the page
+ * pageIndex to cover row. Scans use these ranges to skip pages whose values
+ * cannot satisfy a predicate. Ranges are only ever widened, a delete leaves
+ * them conservative.
+ *
+ * @param pageIndex page the row is written to, may be the next new page
+ * @param row 
+ */
+void Table::updateZoneMap(int pageIndex, vector<int> row)
+{
+    while (this->minValuesPerBlock.size() <= pageIndex)
+    {
+        this->minValuesPerBlock.emplace_back(this->columnCount, INT_MAX);
+        this->maxValuesPerBlock.emplace_back(this->columnCount, INT_MIN);
+    }
+    for (int columnCounter = 0; columnCounter < this->columnCount; columnCounter++)
+    {
+        this->minValuesPerBlock[pageIndex][columnCounter] = min(this->minValuesPerBlock[pageIndex][columnCounter], row[columnCounter]);
+        this->maxValuesPerBlock[pageIndex][columnCounter] = max(this->maxValuesPerBlock[pageIndex][columnCounter], row[columnCounter]);
+    }
+}
+
 /**
  * @brief Checks if the given column is present in this table.
  *
@@ -293,10 +326,22 @@ void Table::getNextPage(Cursor *cursor)
 {
     logger.log("Table::getNext");
 
-    if (cursor->pageIndex < this->blockCount - 1)
+    if (cursor->pageIndex >= 0 && cursor->pageIndex + 1 < (int)this->blockCount)
     {
         cursor->nextPage(cursor->pageIndex + 1);
+        return;
+    }
+    // the pages of the delta store follow the last page
+    vector<int> deltaPages = this->getDeltaPages();
+    auto deltaPage = deltaPages.begin();
+    if (cursor->pageIndex < 0)
+    {
+        deltaPage = find(deltaPages.begin(), deltaPages.end(), cursor->pageIndex);
+        if (deltaPage != deltaPages.end())
+            deltaPage++;
     }
+    if (deltaPage != deltaPages.end())
+        cursor->nextPage(*deltaPage);
 }
 
 /**
@@ -310,11 +355,13 @@ void Table::makePermanent()
     if (!this->isPermanent())
         bufferManager.deleteFile(this->sourceFileName);
     string newSourceFile = "../data/" + this->tableName + ".csv";
-    ofstream fout(newSourceFile, ios::out);
+    // written aside, the old csv stays whole until the new one is
+    ofstream fout(newSourceFile + ".tmp", ios::out);
 
     //print headings
     this->writeRow(this->columns, fout);
 
+    bufferManager.flushPages();
     Cursor cursor(this->tableName, 0);
     vector<int> row;
     for (int rowCounter = 0; rowCounter < this->rowCount; rowCounter++)
@@ -323,6 +370,9 @@ void Table::makePermanent()
         this->writeRow(row, fout);
     }
     fout.close();
+    wal.checkpoint(this->tableName, newSourceFile + ".tmp", newSourceFile);
+    // changes from now on are logged, and replayed over this csv
+    this->sourceFileName = newSourceFile;
 }
 
 /**
@@ -349,6 +399,17 @@ void Table::unload()
     logger.log("Table::~unload");
     for (int pageCounter = 0; pageCounter < this->blockCount; pageCounter++)
         bufferManager.deleteFile(this->tableName, pageCounter);
+    if (this->indexingStrategy == BTREE)
+        bufferManager.deleteFile(this->tableName, -1);
+    for (auto &deltaPage : this->deltaRowsPerBlockCount)
+        bufferManager.deleteFile(this->tableName, deltaPage.first);
+    this->BplusTree.drop();
+    this->Hashing.drop();
+    for (SecondaryIndex &secondaryIndex : this->secondaryIndexes)
+    {
+        secondaryIndex.BplusTree.drop();
+        secondaryIndex.Hashing.drop();
+    }
     if (!isPermanent())
         bufferManager.deleteFile(this->sourceFileName);
 }
@@ -356,12 +417,13 @@ void Table::unload()
 /**
  * @brief Function that returns a cursor that reads rows from this table
  * 
+ * @param columnIndices columns the caller reads, all of them if empty
  * @return Cursor 
  */
-Cursor Table::getCursor()
+Cursor Table::getCursor(vector<int> columnIndices)
 {
     logger.log("Table::getCursor");
-    Cursor cursor(this->tableName, 0);
+    Cursor cursor(this->tableName, 0, columnIndices);
     return cursor;
 }
 
@@ -404,6 +466,24 @@ int Table::checkIndex()
 int Table::indexTable(string columnName, IndexingStrategy indexingStrategy, string thirdParam)
 {
     logger.log("Index::creatingIndex");
+    if ((this->indexed && columnName != this->indexedColumn) || indexingStrategy == BITMAP)
+    {
+        // the table keeps its order, the column gets a secondary index
+        this->addSecondaryIndex(columnName, indexingStrategy, thirdParam);
+        return 0;
+    }
+    // the rows of the delta store are in no primary index but the B+tree
+    this->mergeDelta();
+    for (int i = 0; i < this->secondaryIndexes.size(); i++)
+    {
+        if (this->secondaryIndexes[i].column == columnName)
+        {
+            this->secondaryIndexes[i].BplusTree.drop();
+            this->secondaryIndexes[i].Hashing.drop();
+            this->secondaryIndexes.erase(this->secondaryIndexes.begin() + i);
+            break;
+        }
+    }
     if (indexingStrategy == NOTHING)
     {
         this->indexed = false;
@@ -427,6 +507,7 @@ int Table::indexTable(string columnName, IndexingStrategy indexingStrategy, stri
             // construct a btree
             // thirdParam -> fanout
             this->indexingStrategy = BTREE;
+            this->BplusTree.drop();
             this->BplusTree = bplusTree(this->tableName, thirdParam, this->rowCount, this->indexedColumnNumber);
             this->sortNoIndex(columnName,this->tableName,0);
 
@@ -444,31 +525,24 @@ int Table::indexTable(string columnName, IndexingStrategy indexingStrategy, stri
 
             bufferManager.unloadPages();
 
+            // the pages are sorted now, so the tree is bulk loaded in one pass
+            // with the location of every row
             for (int i = 0; i < this->blockCount; i++)
             {
                 Page page = bufferManager.getPage(this->tableName,i);
                 vector < vector <int> > rows = page.getRows();
-                // cout << rows.size() << endl;
                 int number = page.getRowCount();
                 for (int j = 0; j < number; j++)
-                {
-                    pair <int,int> p = this->BplusTree.search(rows[j][this->indexedColumnNumber]);
-                    if(p.first == -1){
-                        // cout << "debug statement " << rows[j][this->indexedColumnNumber]  << endl;
-                        // only insert if not already there
-                        this->BplusTree.insert(rows[j][this->indexedColumnNumber],i,j);
-                    }
-                }
-                
+                    this->BplusTree.bulkInsert(rows[j][this->indexedColumnNumber],i,j);
             }
-            // this->BplusTree.removeKey(6);
-            this->BplusTree.display(this->BplusTree.getRoot());
+            this->BplusTree.bulkBuild();
         }
         else
         {
             // construct a hash
             // thirdParam -> number of buckets
             this->indexingStrategy = HASH;
+            this->Hashing.drop();
             this->Hashing = hashing(this->tableName, stoi(thirdParam), this->rowCount, this->indexedColumnNumber);
             for (int i = 0; i < this->blockCount; i++)
             {
@@ -478,78 +552,335 @@ int Table::indexTable(string columnName, IndexingStrategy indexingStrategy, stri
                 int number = page.getRowCount();
                 for (int j = 0; j < number; j++)
                 {
-                    this->Hashing.insertItem(rows[j][this->indexedColumnNumber],i,j);
+                    if (!this->isDeleted(i, j))
+                        this->Hashing.bulkInsert(rows[j][this->indexedColumnNumber],i,j);
                 }
             }
+            this->Hashing.bulkBuild();
             this->Hashing.displayHash();
             
         }
     }
+    // the rows may have moved, locate them again
+    this->rebuildSecondaryIndexes();
+    return 0;
 }
 
+/**
+ * @brief Function that returns the secondary index on a column
+ *
+ * @param columnName
+ * @return SecondaryIndex* NULL if the column has none
+ */
+SecondaryIndex *Table::getSecondaryIndex(string columnName)
+{
+    for (SecondaryIndex &secondaryIndex : this->secondaryIndexes)
+        if (secondaryIndex.column == columnName)
+            return &secondaryIndex;
+    return NULL;
+}
 
 /**
- * @brief Function that inserts at the last like a normal insert
- * 
- * @param  2D vector
- * @return pagePtr,rowPtr pair
+ * @brief Function that reads the values of a column in [low, high] from the
+ * leaves of a B+tree on it, without fetching the pages of the table. A
+ * secondary tree holds every row. The primary tree misses the rows of the
+ * delta store, which are searched for the range on their own.
+ *
+ * @param columnName
+ * @param low
+ * @param high
+ * @param keys out: the value of every row in the range, in increasing order
+ * @return false if the column has no B+tree
  */
-pair<int,int> Table::insertLast(vector<int> values)
+bool Table::indexKeys(string columnName, int low, int high, vector<int> &keys)
 {
-    uint count = this->rowCount;
+    logger.log("Table::indexKeys");
+    SecondaryIndex *secondaryIndex = this->getSecondaryIndex(columnName);
+    if (secondaryIndex && secondaryIndex->indexingStrategy == BTREE)
+    {
+        keys = secondaryIndex->BplusTree.searchKeys(low, high);
+        return true;
+    }
+    if (!this->indexed || this->indexingStrategy != BTREE || this->indexedColumn != columnName)
+        return false;
+    keys = this->BplusTree.searchKeys(low, high);
+    vector<pair<int,int>> deltaLocations;
+    vector<vector<int>> deltaRows;
+    this->searchDelta(low, high, deltaLocations, deltaRows);
+    if (!deltaRows.empty())
+    {
+        int sortedCount = keys.size();
+        for (auto &row : deltaRows)
+            keys.push_back(row[this->indexedColumnNumber]);
+        sort(keys.begin() + sortedCount, keys.end());
+        inplace_merge(keys.begin(), keys.begin() + sortedCount, keys.end());
+    }
+    return true;
+}
 
-    cout << "row count of this table is " << this->rowCount << endl;
-    this->rowCount++;
-    int blkiter = 0;
-    bool flag = 0;
-    int wherePage = -1;
-    int whereRow = -1;
-    for (int itr = 0; itr < this->rowsPerBlockCount.size();itr++)
+/**
+ * @brief Function that creates, replaces or (with NOTHING) removes the
+ * secondary index on a column. The pages are left as they are.
+ *
+ * @param columnName
+ * @param indexingStrategy
+ * @param thirdParam fanout or number of buckets
+ */
+void Table::addSecondaryIndex(string columnName, IndexingStrategy indexingStrategy, string thirdParam)
+{
+    logger.log("Table::addSecondaryIndex");
+    SecondaryIndex *secondaryIndex = this->getSecondaryIndex(columnName);
+    if (secondaryIndex)
     {
-        int d = this->rowsPerBlockCount[itr];
-        cout << d << " ";
-        if (d < this->maxRowsPerBlock)
-        {
-            cout << d << " ";
-            flag = 1;
-            wherePage = blkiter;
-            whereRow = this->rowsPerBlockCount[blkiter];
-            this->rowsPerBlockCount[blkiter]++;
-            Page lastPage = bufferManager.getPage(this->tableName, blkiter);
-            lastPage.insertPageRow(values);
-            bufferManager.updatePage(this->tableName + "_Page" + to_string(blkiter), lastPage);
-        }
-        blkiter++;
+        secondaryIndex->BplusTree.drop();
+        secondaryIndex->Hashing.drop();
     }
-    cout << endl;
-    // in case no block is vacant
-    cout << "row count of this table is " << this->rowCount << endl;
-    for (auto d : this->rowsPerBlockCount)
+    if (indexingStrategy == NOTHING)
     {
-        cout << d << " ";
+        if (secondaryIndex)
+            this->secondaryIndexes.erase(this->secondaryIndexes.begin() + (secondaryIndex - &this->secondaryIndexes[0]));
+        return;
     }
-    if (flag == 0)
+    if (!secondaryIndex)
     {
-        if(this->rowsPerBlockCount[this->blockCount - 1] >= this->maxRowsPerBlock){
-            // new last page also full kya hi kar sakte hai
-            vector < vector <int>> va;
-            va.push_back(values);
-            bufferManager.writePage(this->tableName,this->blockCount++,va,1);
-            printRowCount(this->rowCount);
-            return {this->blockCount - 1,0};
+        this->secondaryIndexes.emplace_back();
+        secondaryIndex = &this->secondaryIndexes.back();
+    }
+    secondaryIndex->column = columnName;
+    secondaryIndex->columnIndex = this->getColumnIndex(columnName);
+    secondaryIndex->indexingStrategy = indexingStrategy;
+    secondaryIndex->thirdParam = thirdParam;
+    this->buildSecondaryIndex(*secondaryIndex);
+}
+
+/**
+ * @brief Function that builds a secondary index from scratch over every row of
+ * the table, the rows of the delta store included.
+ *
+ * @param secondaryIndex
+ */
+void Table::buildSecondaryIndex(SecondaryIndex &secondaryIndex)
+{
+    logger.log("Table::buildSecondaryIndex");
+    uint column = secondaryIndex.columnIndex;
+    // (key, page, row) of every row
+    vector<tuple<int, int, int>> entries;
+    entries.reserve(this->rowCount);
+    vector<int> pageIndices = this->getDeltaPages();
+    for (int i = 0; i < (int)this->blockCount; i++)
+        pageIndices.push_back(i);
+    for (int i : pageIndices)
+    {
+        Page page = bufferManager.getPage(this->tableName, i);
+        vector<vector<int>> rows = page.getRows();
+        int number = page.getRowCount();
+        for (int j = 0; j < number; j++)
+            if (!this->isDeleted(i, j))
+                entries.emplace_back(rows[j][column], i, j);
+    }
+    this->loadSecondaryIndex(secondaryIndex, entries);
+}
+
+/**
+ * @brief Function that builds a secondary index from scratch out of the
+ * entries of every row of the table
+ *
+ * @param secondaryIndex
+ * @param entries (key, page, row) of every row, in any order
+ */
+void Table::loadSecondaryIndex(SecondaryIndex &secondaryIndex, vector<tuple<int, int, int>> &entries)
+{
+    logger.log("Table::loadSecondaryIndex");
+    uint column = secondaryIndex.columnIndex;
+    if (secondaryIndex.indexingStrategy == BTREE)
+    {
+        secondaryIndex.BplusTree.drop();
+        secondaryIndex.BplusTree = bplusTree(this->tableName, secondaryIndex.thirdParam, this->rowCount, column);
+        sort(entries.begin(), entries.end());
+        for (auto &entry : entries)
+            secondaryIndex.BplusTree.bulkInsert(get<0>(entry), get<1>(entry), get<2>(entry));
+        secondaryIndex.BplusTree.bulkBuild();
+    }
+    else if (secondaryIndex.indexingStrategy == HASH)
+    {
+        secondaryIndex.Hashing.drop();
+        secondaryIndex.Hashing = hashing(this->tableName, stoi(secondaryIndex.thirdParam), this->rowCount, column);
+        for (auto &entry : entries)
+            secondaryIndex.Hashing.bulkInsert(get<0>(entry), get<1>(entry), get<2>(entry));
+        secondaryIndex.Hashing.bulkBuild();
+    }
+    else
+    {
+        secondaryIndex.Bitmap = bitmapIndex(this->maxRowsPerBlock);
+        for (auto &entry : entries)
+            secondaryIndex.Bitmap.insertItem(get<0>(entry), get<1>(entry), get<2>(entry));
+    }
+}
+
+/**
+ * @brief Function that rebuilds every secondary index, after the rows of the
+ * table have been moved around
+ */
+void Table::rebuildSecondaryIndexes()
+{
+    logger.log("Table::rebuildSecondaryIndexes");
+    for (SecondaryIndex &secondaryIndex : this->secondaryIndexes)
+        this->buildSecondaryIndex(secondaryIndex);
+}
+
+/**
+ * @brief Function that adds a newly inserted row to every secondary index
+ *
+ * @param row
+ * @param pageIndex where the row was written
+ * @param rowIndex
+ */
+void Table::indexSecondaryRow(vector<int> row, int pageIndex, int rowIndex)
+{
+    for (SecondaryIndex &secondaryIndex : this->secondaryIndexes)
+    {
+        int key = row[secondaryIndex.columnIndex];
+        if (secondaryIndex.indexingStrategy == BTREE)
+            secondaryIndex.BplusTree.insert(key, pageIndex, rowIndex);
+        else if (secondaryIndex.indexingStrategy == HASH)
+            secondaryIndex.Hashing.insertItem(key, pageIndex, rowIndex);
+        else
+            secondaryIndex.Bitmap.insertItem(key, pageIndex, rowIndex);
+    }
+}
+
+/**
+ * @brief Function that adds a batch of newly inserted rows to every secondary
+ * index. The B+tree entries go in in key order, so that the inserts that
+ * follow one another land in the same leaf.
+ *
+ * @param rows
+ * @param locations where each row was written
+ */
+void Table::indexSecondaryRows(vector<vector<int>> &rows, vector<pair<int,int>> &locations)
+{
+    logger.log("Table::indexSecondaryRows");
+    for (SecondaryIndex &secondaryIndex : this->secondaryIndexes)
+    {
+        vector<tuple<int, int, int>> entries;
+        for (int rowCounter = 0; rowCounter < rows.size(); rowCounter++)
+            entries.emplace_back(rows[rowCounter][secondaryIndex.columnIndex], locations[rowCounter].first, locations[rowCounter].second);
+        if (secondaryIndex.indexingStrategy == BTREE)
+            sort(entries.begin(), entries.end());
+        for (auto &entry : entries)
+        {
+            if (secondaryIndex.indexingStrategy == BTREE)
+                secondaryIndex.BplusTree.insert(get<0>(entry), get<1>(entry), get<2>(entry));
+            else if (secondaryIndex.indexingStrategy == HASH)
+                secondaryIndex.Hashing.insertItem(get<0>(entry), get<1>(entry), get<2>(entry));
+            else
+                secondaryIndex.Bitmap.insertItem(get<0>(entry), get<1>(entry), get<2>(entry));
         }
     }
-    else{
-        return {wherePage,whereRow};
+}
+
+/**
+ * @brief Function that removes a deleted row from every secondary index
+ *
+ * @param row the deleted row
+ * @param pageIndex
+ * @param rowIndex where the deleted row was
+ */
+void Table::unindexSecondaryRow(vector<int> row, int pageIndex, int rowIndex)
+{
+    for (SecondaryIndex &secondaryIndex : this->secondaryIndexes)
+    {
+        int key = row[secondaryIndex.columnIndex];
+        if (secondaryIndex.indexingStrategy == BTREE)
+            secondaryIndex.BplusTree.removeKey(key, pageIndex, rowIndex);
+        else if (secondaryIndex.indexingStrategy == HASH)
+            secondaryIndex.Hashing.deleteItem(key, pageIndex, rowIndex);
+        else
+            secondaryIndex.Bitmap.deleteItem(key, pageIndex, rowIndex);
     }
+}
 
+/**
+ * @brief Function that points the entries of a row in every secondary index
+ * at the slot of its page it moved to
+ *
+ * @param row
+ * @param pageIndex
+ * @param fromRow
+ * @param toRow
+ */
+void Table::relocateSecondaryRow(vector<int> row, int pageIndex, int fromRow, int toRow)
+{
+    for (SecondaryIndex &secondaryIndex : this->secondaryIndexes)
+    {
+        int key = row[secondaryIndex.columnIndex];
+        if (secondaryIndex.indexingStrategy == BTREE)
+            secondaryIndex.BplusTree.relocate(key, pageIndex, fromRow, toRow);
+        else if (secondaryIndex.indexingStrategy == HASH)
+        {
+            secondaryIndex.Hashing.deleteItem(key, pageIndex, fromRow);
+            secondaryIndex.Hashing.insertItem(key, pageIndex, toRow);
+        }
+        else
+        {
+            secondaryIndex.Bitmap.deleteItem(key, pageIndex, fromRow);
+            secondaryIndex.Bitmap.insertItem(key, pageIndex, toRow);
+        }
+    }
 }
 
+
 /**
- * @brief Function that inserts a row of values into Table
+ * @brief Function that inserts at the last like a normal insert. The rows go
+ * to the pages compaction left room in first, then to the tail page, and to a
+ * new tail page once it is full. The page is changed in the buffer pool only
+ * and written back when it leaves the pool.
  * 
  * @param  2D vector
- * @return int (yes or no) 
+ * @return pagePtr,rowPtr pair
+ */
+pair<int,int> Table::insertLast(vector<int> values)
+{
+    logger.log("Table::insertLast");
+    this->rowCount++;
+    uint pageIndex = this->blockCount;
+    while (!this->freeSpacePages.empty())
+    {
+        // the map is only a hint, pages filled or dropped since are skipped
+        uint freePage = *this->freeSpacePages.begin();
+        if (freePage < this->blockCount && this->rowsPerBlockCount[freePage] < this->maxRowsPerBlock)
+        {
+            pageIndex = freePage;
+            break;
+        }
+        this->freeSpacePages.erase(this->freeSpacePages.begin());
+    }
+    if (pageIndex == this->blockCount && this->blockCount && this->rowsPerBlockCount[this->blockCount - 1] < this->maxRowsPerBlock)
+        pageIndex = this->blockCount - 1;
+    this->updateZoneMap(pageIndex, values);
+    Page page;
+    if (pageIndex == this->blockCount)
+    {
+        vector<vector<int>> rows(this->maxRowsPerBlock, vector<int>(this->columnCount, 0));
+        page = Page(this->tableName, pageIndex, rows, 0, this->pageLayout);
+        this->rowsPerBlockCount.emplace_back(0);
+        this->blockCount++;
+    }
+    else
+        page = bufferManager.getPage(this->tableName, pageIndex);
+    int rowIndex = this->rowsPerBlockCount[pageIndex]++;
+    page.insertPageRow(values);
+    bufferManager.updatePage(this->tableName + "_Page" + to_string(pageIndex), page, true);
+    return {pageIndex, rowIndex};
+}
+
+/**
+ * @brief Function that inserts a row of values into Table. A table clustered
+ * on its B+tree takes it into its overflow page, which goes to the delta
+ * store as a sorted run once it is full.
+ *
+ * @param  2D vector
+ * @return int (yes or no)
  */
 int Table::insertRow(vector<int> values)
 {
@@ -558,28 +889,18 @@ int Table::insertRow(vector<int> values)
         cout << "Indexed Table" << endl;
         if(this->indexingStrategy == BTREE){
             // do not insert at last, insert in the overflow page instead
-            pair <int,int> p = this->BplusTree.search(values[this->indexedColumnNumber]);
-            // pair<int,int> p = this->insertLast(values);
             Page page = bufferManager.getPage(this->tableName,-1);
-            if(page.getRowCount() == this->maxRowsPerBlock){
-                // block full re-index
-                Page page1 = bufferManager.getPage(this->tableName,-1);
-                Page page2 = bufferManager.getPage(this->tableName,this->blockCount++);
-                page2.writeRows(page1.getRows(),page1.getRowCount());
-                page2.writePage();
-                sortNoIndex(this->indexedColumn,this->tableName,false);
-                this->indexTable(this->indexedColumn,BTREE,this->thirdParam);               
-            }
-            else{
-                vector <vector <int> > rows;
-                if(page.getRowCount() != 0){
-                    rows = page.getRows();
-                }
-                pair <int,int> p = this->BplusTree.search(values[this->indexedColumnNumber]);
-                rows.push_back(values);
-                page.writeRows(rows, page.getRowCount() + 1);
-                page.writePage();
-                bufferManager.updatePage(this->tableName + "_Page" + to_string(-1),page);
+            vector <vector <int> > rows = page.getRows();
+            rows[this->overflowRowCount] = values;
+            this->overflowRowCount++;
+            this->rowCount++;
+            page.writeRows(rows, this->overflowRowCount);
+            bufferManager.updatePage(this->tableName + "_Page" + to_string(-1), page, true);
+            this->indexSecondaryRow(values, -1, this->overflowRowCount - 1);
+            if(this->overflowRowCount == this->maxRowsPerBlock){
+                this->flushOverflowPage();
+                if (this->deltaFull())
+                    tableCatalogue.mergeInBackground(this);
             }
             return 0;
         }
@@ -589,15 +910,393 @@ int Table::insertRow(vector<int> values)
             pair<int,int> p = this->insertLast(values);
             this->Hashing.insertItem(values[this->indexedColumnNumber],p.first,p.second);
             this->Hashing.displayHash();
-        }   
+            this->indexSecondaryRow(values, p.first, p.second);
+        }
     }
     else
     {
         // not indexed, normal insert
         pair<int,int> p = this->insertLast(values);
+        this->indexSecondaryRow(values, p.first, p.second);
     }
-    
+    return 0;
+
+}
+
+/**
+ * @brief Function that inserts a batch of rows, as BULK_INSERT does. The
+ * indexes are kept up to date entry by entry, none is rebuilt. A table
+ * clustered on its B+tree takes a batch into its overflow page when it fits,
+ * otherwise the batch is sorted and becomes a run of the delta store.
+ *
+ * @param rows
+ * @return int
+ */
+int Table::insertRows(vector<vector<int>> &rows)
+{
+    logger.log("Table::insertRows");
+    if (rows.empty())
+        return 0;
+    vector<pair<int,int>> locations;
+    if (this->indexed && this->indexingStrategy == BTREE)
+    {
+        if (this->overflowRowCount + rows.size() > this->maxRowsPerBlock)
+        {
+            int column = this->indexedColumnNumber;
+            vector<vector<int>> sortedRows = rows;
+            stable_sort(sortedRows.begin(), sortedRows.end(), [column](const vector<int> &row1, const vector<int> &row2) { return row1[column] < row2[column]; });
+            // the level of the runs of about as many pages
+            uint level = 0;
+            for (uint pageCount = sortedRows.size() / this->maxRowsPerBlock; pageCount >= DELTA_RUNS_PER_LEVEL; pageCount /= DELTA_RUNS_PER_LEVEL)
+                level++;
+            this->rowCount += sortedRows.size();
+            this->addDeltaRun(sortedRows, locations, level);
+            this->indexSecondaryRows(sortedRows, locations);
+            this->mergeDeltaRuns();
+        }
+        else
+        {
+            Page page = bufferManager.getPage(this->tableName, -1);
+            vector<vector<int>> overflowRows = page.getRows();
+            for (auto &row : rows)
+            {
+                overflowRows[this->overflowRowCount] = row;
+                locations.push_back({-1, (int)this->overflowRowCount});
+                this->overflowRowCount++;
+                this->rowCount++;
+            }
+            page.writeRows(overflowRows, this->overflowRowCount);
+            bufferManager.updatePage(this->tableName + "_Page" + to_string(-1), page, true);
+            this->indexSecondaryRows(rows, locations);
+            if (this->overflowRowCount == this->maxRowsPerBlock)
+                this->flushOverflowPage();
+        }
+        if (this->deltaFull())
+            tableCatalogue.mergeInBackground(this);
+        return 0;
+    }
+    for (auto &row : rows)
+        locations.push_back(this->insertLast(row));
+    if (this->indexed)
+        for (int rowCounter = 0; rowCounter < rows.size(); rowCounter++)
+            this->Hashing.insertItem(rows[rowCounter][this->indexedColumnNumber], locations[rowCounter].first, locations[rowCounter].second);
+    this->indexSecondaryRows(rows, locations);
+    return 0;
+}
+
+/**
+ * @brief Function that tells how many rows a page of the table holds, the
+ * overflow page and the pages of the delta store included
+ *
+ * @param pageIndex
+ * @return uint
+ */
+uint Table::getPageRowCount(int pageIndex)
+{
+    if (pageIndex == -1)
+        return this->overflowRowCount;
+    if (pageIndex < 0)
+    {
+        auto deltaPage = this->deltaRowsPerBlockCount.find(pageIndex);
+        return deltaPage == this->deltaRowsPerBlockCount.end() ? 0 : deltaPage->second;
+    }
+    return pageIndex < this->rowsPerBlockCount.size() ? this->rowsPerBlockCount[pageIndex] : 0;
+}
+
+/**
+ * @brief Function that returns the pages of the delta store: the overflow
+ * page if it holds rows, then the pages of every run, oldest run first
+ *
+ * @return vector<int>
+ */
+vector<int> Table::getDeltaPages()
+{
+    vector<int> pageIndices;
+    if (this->indexed && this->indexingStrategy == BTREE && this->overflowRowCount)
+        pageIndices.push_back(-1);
+    for (DeltaRun &run : this->deltaRuns)
+        pageIndices.insert(pageIndices.end(), run.pages.begin(), run.pages.end());
+    return pageIndices;
+}
+
+/**
+ * @brief Function that finds the rows of the delta store whose key, the value
+ * of the column of the primary B+tree, is in [low, high]. The overflow page is
+ * read whole. A run is skipped unless its keys overlap the range, and only its
+ * pages that may hold the range are read, found from the first key of each.
+ *
+ * @param low
+ * @param high
+ * @param locations out: page and row of every row found
+ * @param rows out: the rows found
+ */
+void Table::searchDelta(int low, int high, vector<pair<int,int>> &locations, vector<vector<int>> &rows)
+{
+    logger.log("Table::searchDelta");
+    int column = this->indexedColumnNumber;
+    if (this->overflowRowCount)
+    {
+        Page page = bufferManager.getPage(this->tableName, -1);
+        vector<vector<int>> pageRows = page.getRows();
+        for (int rowCounter = 0; rowCounter < this->overflowRowCount; rowCounter++)
+            if (pageRows[rowCounter][column] >= low && pageRows[rowCounter][column] <= high)
+            {
+                locations.push_back({-1, rowCounter});
+                rows.push_back(pageRows[rowCounter]);
+            }
+    }
+    for (DeltaRun &run : this->deltaRuns)
+    {
+        if (run.maxKey < low || run.minKey > high)
+            continue;
+        // the last page starting below low may end with it
+        int pageCounter = lower_bound(run.firstKeys.begin(), run.firstKeys.end(), low) - run.firstKeys.begin();
+        for (pageCounter = max(pageCounter - 1, 0); pageCounter < run.pages.size() && run.firstKeys[pageCounter] <= high; pageCounter++)
+        {
+            int pageIndex = run.pages[pageCounter];
+            uint pageRowCount = this->getPageRowCount(pageIndex);
+            if (!pageRowCount)
+                continue;
+            Page page = bufferManager.getPage(this->tableName, pageIndex);
+            vector<vector<int>> pageRows = page.getRows();
+            int rowCounter = lower_bound(pageRows.begin(), pageRows.begin() + pageRowCount, low, [column](const vector<int> &row, int key) { return row[column] < key; }) - pageRows.begin();
+            for (; rowCounter < pageRowCount && pageRows[rowCounter][column] <= high; rowCounter++)
+            {
+                locations.push_back({pageIndex, rowCounter});
+                rows.push_back(pageRows[rowCounter]);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Function that writes rows sorted on the key out as a new run of the
+ * delta store, on pages numbered below those already in use
+ *
+ * @param rows sorted on the column of the primary B+tree
+ * @param locations out: where each row was written
+ * @param level
+ */
+void Table::addDeltaRun(vector<vector<int>> &rows, vector<pair<int,int>> &locations, uint level)
+{
+    logger.log("Table::addDeltaRun");
+    int column = this->indexedColumnNumber;
+    DeltaRun run;
+    run.level = level;
+    run.minKey = rows.front()[column];
+    run.maxKey = rows.back()[column];
+    int pageIndex = -1;
+    for (int offset = 0; offset < rows.size(); offset += this->maxRowsPerBlock)
+    {
+        // the pages of runs merged away are taken again
+        do
+            pageIndex--;
+        while (this->deltaRowsPerBlockCount.count(pageIndex));
+        int pageRowCount = min((int)this->maxRowsPerBlock, (int)rows.size() - offset);
+        vector<vector<int>> pageRows(rows.begin() + offset, rows.begin() + offset + pageRowCount);
+        pageRows.resize(this->maxRowsPerBlock, vector<int>(this->columnCount, 0));
+        this->deltaRowsPerBlockCount[pageIndex] = pageRowCount;
+        bufferManager.writePage(this->tableName, pageIndex, pageRows, pageRowCount, this->pageLayout);
+        run.pages.push_back(pageIndex);
+        run.firstKeys.push_back(pageRows[0][column]);
+        for (int rowCounter = 0; rowCounter < pageRowCount; rowCounter++)
+            locations.push_back({pageIndex, rowCounter});
+    }
+    this->deltaRowCount += rows.size();
+    this->deltaRuns.push_back(run);
+}
+
+/**
+ * @brief Function that sorts the rows of the full overflow page into a run of
+ * level 0, and empties the page. Their secondary index entries follow them.
+ */
+void Table::flushOverflowPage()
+{
+    logger.log("Table::flushOverflowPage");
+    int column = this->indexedColumnNumber;
+    Page page = bufferManager.getPage(this->tableName, -1);
+    vector<vector<int>> rows = page.getRows();
+    rows.resize(this->overflowRowCount);
+    for (int rowCounter = 0; rowCounter < rows.size(); rowCounter++)
+        this->unindexSecondaryRow(rows[rowCounter], -1, rowCounter);
+    this->overflowRowCount = 0;
+    bufferManager.deleteFile(this->tableName, -1);
+    stable_sort(rows.begin(), rows.end(), [column](const vector<int> &row1, const vector<int> &row2) { return row1[column] < row2[column]; });
+    vector<pair<int,int>> locations;
+    this->addDeltaRun(rows, locations, 0);
+    this->indexSecondaryRows(rows, locations);
+    this->mergeDeltaRuns();
+}
+
+/**
+ * @brief Function that keeps the delta store tiered. Once a level has
+ * DELTA_RUNS_PER_LEVEL runs, they are merged into one run of the next level,
+ * so a row is rewritten once per level, about log(n) times before it reaches
+ * the pages of the table.
+ */
+void Table::mergeDeltaRuns()
+{
+    logger.log("Table::mergeDeltaRuns");
+    int column = this->indexedColumnNumber;
+    for (uint level = 0; ; level++)
+    {
+        vector<int> runIndices;
+        bool higherLevels = false;
+        for (int runCounter = 0; runCounter < this->deltaRuns.size(); runCounter++)
+        {
+            if (this->deltaRuns[runCounter].level == level)
+                runIndices.push_back(runCounter);
+            else if (this->deltaRuns[runCounter].level > level)
+                higherLevels = true;
+        }
+        if (runIndices.size() < DELTA_RUNS_PER_LEVEL)
+        {
+            if (!higherLevels)
+                break;
+            continue;
+        }
+
+        // older runs first, so that equal keys keep the order they came in
+        vector<vector<int>> rows;
+        for (int runIndex : runIndices)
+            for (int pageIndex : this->deltaRuns[runIndex].pages)
+            {
+                Page page = bufferManager.getPage(this->tableName, pageIndex);
+                vector<vector<int>> pageRows = page.getRows();
+                uint pageRowCount = this->getPageRowCount(pageIndex);
+                for (int rowCounter = 0; rowCounter < pageRowCount; rowCounter++)
+                    this->unindexSecondaryRow(pageRows[rowCounter], pageIndex, rowCounter);
+                rows.insert(rows.end(), pageRows.begin(), pageRows.begin() + pageRowCount);
+                this->deltaRowCount -= pageRowCount;
+                this->deltaRowsPerBlockCount.erase(pageIndex);
+                bufferManager.deleteFile(this->tableName, pageIndex);
+            }
+        for (int runCounter = runIndices.size() - 1; runCounter >= 0; runCounter--)
+            this->deltaRuns.erase(this->deltaRuns.begin() + runIndices[runCounter]);
+        if (rows.empty())
+            continue;
+        stable_sort(rows.begin(), rows.end(), [column](const vector<int> &row1, const vector<int> &row2) { return row1[column] < row2[column]; });
+        vector<pair<int,int>> locations;
+        this->addDeltaRun(rows, locations, level + 1);
+        this->indexSecondaryRows(rows, locations);
+    }
+}
+
+/**
+ * @brief Function that tells whether the delta store has grown to
+ * DELTA_MERGE_RATIO of the rows of the pages, and should be merged into them
+ *
+ * @return bool
+ */
+bool Table::deltaFull()
+{
+    long long pagesRowCount = this->rowCount - this->overflowRowCount - this->deltaRowCount;
+    return this->deltaRowCount > DELTA_MERGE_RATIO * pagesRowCount;
+}
+
+/**
+ * @brief Function that merges the delta store, the overflow page and every
+ * run, into the pages of a table clustered on its B+tree. The rows of the
+ * delta store are sorted in memory, and merged with the rows of the pages,
+ * already in order, in one pass that writes the pages back full and feeds
+ * every index its entries in the same order. No page is written before it has
+ * been read. Run by the catalogue in the background, between two commands.
+ */
+void Table::mergeDelta()
+{
+    logger.log("Table::mergeDelta");
+    if (!this->overflowRowCount && this->deltaRuns.empty())
+        return;
+    int column = this->indexedColumnNumber;
+    vector<vector<int>> batch;
+    for (int pageIndex : this->getDeltaPages())
+    {
+        Page page = bufferManager.getPage(this->tableName, pageIndex);
+        vector<vector<int>> pageRows = page.getRows();
+        batch.insert(batch.end(), pageRows.begin(), pageRows.begin() + this->getPageRowCount(pageIndex));
+        bufferManager.deleteFile(this->tableName, pageIndex);
+    }
+    this->rowCount -= this->overflowRowCount + this->deltaRowCount;
+    this->overflowRowCount = 0;
+    this->deltaRuns.clear();
+    this->deltaRowsPerBlockCount.clear();
+    this->deltaRowCount = 0;
+    stable_sort(batch.begin(), batch.end(), [column](const vector<int> &row1, const vector<int> &row2) { return row1[column] < row2[column]; });
+
+    this->BplusTree.drop();
+    this->BplusTree = bplusTree(this->tableName, this->thirdParam, this->rowCount + batch.size(), column);
+    vector<vector<tuple<int, int, int>>> secondaryEntries(this->secondaryIndexes.size());
+
+    // rows of the pages read, not merged yet
+    deque<vector<int>> pending;
+    uint inputBlockCount = this->blockCount;
+    uint nextInputPage = 0;
+    auto readInputPage = [&]() {
+        Page page = bufferManager.getPage(this->tableName, nextInputPage);
+        vector<vector<int>> pageRows = page.getRows();
+        for (int rowCounter = 0; rowCounter < this->rowsPerBlockCount[nextInputPage]; rowCounter++)
+            if (!this->isDeleted(nextInputPage, rowCounter))
+                pending.push_back(pageRows[rowCounter]);
+        nextInputPage++;
+    };
+
+    vector<vector<int>> outputRows;
+    vector<uint> outputRowsPerBlockCount;
+    this->minValuesPerBlock.clear();
+    this->maxValuesPerBlock.clear();
+    auto writeOutputPage = [&]() {
+        uint pageIndex = outputRowsPerBlockCount.size();
+        while (nextInputPage <= pageIndex && nextInputPage < inputBlockCount)
+            readInputPage();
+        for (int rowCounter = 0; rowCounter < outputRows.size(); rowCounter++)
+        {
+            this->BplusTree.bulkInsert(outputRows[rowCounter][column], pageIndex, rowCounter);
+            for (int indexCounter = 0; indexCounter < this->secondaryIndexes.size(); indexCounter++)
+                secondaryEntries[indexCounter].emplace_back(outputRows[rowCounter][this->secondaryIndexes[indexCounter].columnIndex], pageIndex, rowCounter);
+            this->updateZoneMap(pageIndex, outputRows[rowCounter]);
+        }
+        int outputRowCount = outputRows.size();
+        outputRows.resize(this->maxRowsPerBlock, vector<int>(this->columnCount, 0));
+        bufferManager.writePage(this->tableName, pageIndex, outputRows, outputRowCount, this->pageLayout);
+        outputRowsPerBlockCount.push_back(outputRowCount);
+        outputRows.clear();
+    };
+
+    int batchCounter = 0;
+    while (true)
+    {
+        while (pending.empty() && nextInputPage < inputBlockCount)
+            readInputPage();
+        if (pending.empty() && batchCounter == batch.size())
+            break;
+        // equal keys keep the rows already in the table first
+        if (!pending.empty() && (batchCounter == batch.size() || pending.front()[column] <= batch[batchCounter][column]))
+        {
+            outputRows.push_back(pending.front());
+            pending.pop_front();
+        }
+        else
+            outputRows.push_back(batch[batchCounter++]);
+        if (outputRows.size() == this->maxRowsPerBlock)
+            writeOutputPage();
+    }
+    if (!outputRows.empty())
+        writeOutputPage();
 
+    // the deleted rows were left out, there may be fewer pages than before
+    for (uint pageCounter = outputRowsPerBlockCount.size(); pageCounter < inputBlockCount; pageCounter++)
+        bufferManager.deleteFile(this->tableName, pageCounter);
+    this->blockCount = outputRowsPerBlockCount.size();
+    this->rowsPerBlockCount = outputRowsPerBlockCount;
+    this->rowCount = 0;
+    for (uint count : outputRowsPerBlockCount)
+        this->rowCount += count;
+    this->deletedRowsPerBlock.clear();
+    this->deletedRowsPerBlockCount.clear();
+    this->freeSpacePages.clear();
+    this->BplusTree.bulkBuild();
+    for (int indexCounter = 0; indexCounter < this->secondaryIndexes.size(); indexCounter++)
+        this->loadSecondaryIndex(this->secondaryIndexes[indexCounter], secondaryEntries[indexCounter]);
 }
 
 /**
@@ -624,6 +1323,8 @@ bool sortcol(const vector<int> &v1, const vector<int> &v2, int k)
  */
 int Table::sortDesc(string columnName,string finName, bool toInsert , int buffersizeM ) /* toInsert =1  buffersizeM =10*/
 {
+    // the runs are built from whole pages, so the deleted rows go first
+    this->compactAll();
     int blkiter = 0;
     int m = buffersizeM;
     // cout << "value of m is " << m << endl; 
@@ -857,6 +1558,8 @@ int Table::sortDesc(string columnName,string finName, bool toInsert , int buffer
  */
 int Table::sortNoIndex(string columnName,string finName, bool toInsert , int buffersizeM ) /* toInsert =1  buffersizeM =10*/
 {
+    // the runs are built from whole pages, so the deleted rows go first
+    this->compactAll();
     int blkiter = 0;
     int m = buffersizeM;
     // cout << "value of m is " << m << endl; 
@@ -868,47 +1571,34 @@ int Table::sortNoIndex(string columnName,string finName, bool toInsert , int buf
     
     Table* phase1res = new Table("_Y"+this->tableName, this->columns);
 
+    // pages need not be full, nor sized like those of phase1res after an
+    // ALTER ... ADD, so the rows are regrouped into full runs of its
+    // maxRowsPerBlock before sorting, keeping every run a page of its own
+    vector<vector<int>> runRows;
     for (auto d : this->rowsPerBlockCount)
     {
-        // cout << "page" << d << "\n";
         if (d > 0)
         {
             Page curPage = bufferManager.getPage(this->tableName, blkiter);
             vector<vector<int>> pageRows = curPage.getRows();
-            pageRows = vector<vector<int>>(pageRows.begin(), pageRows.end()-pageRows.size()+d);
-            int m = pageRows.size();
-            int n = pageRows[0].size();
-            // cout << "The Page rows before sorting are:\n";
-            // for (int i = 0; i < m; i++)
-            // {
-            //     for (int j = 0; j < n; j++)
-            //         cout << pageRows[i][j] << " ";
-            //     cout << endl;
-            // }
-
-            // cout << "got page " << curPage.pageName << endl;
-            
+            runRows.insert(runRows.end(), pageRows.begin(), pageRows.begin() + d);
+        }
+        blkiter++;
+        while (runRows.size() >= phase1res->maxRowsPerBlock || (blkiter == this->blockCount && !runRows.empty()))
+        {
+            int d = min((int)runRows.size(), (int)phase1res->maxRowsPerBlock);
+            vector<vector<int>> pageRows(runRows.begin(), runRows.begin() + d);
+            runRows.erase(runRows.begin(), runRows.begin() + d);
             sort(pageRows.begin(), pageRows.end(), [indk]( const vector<int> &v1, const vector<int> &v2){ return v1[indk] < v2[indk]; } );
-            // cout << "The Page rows after sorting are:\n";
-            // for (int i = 0; i < m; i++)
-            // {
-            //     for (int j = 0; j < n; j++)
-            //         cout << pageRows[i][j] << " ";
-            //     cout << endl;
-            // }
-
-            // TODO : problem is where to write the sorted page ..??
             phase1res->writeRows(pageRows);
-            // bufferManager.writePage("Temp",blkiter,pageRows,d);
-
         }
-
-
-        blkiter++;
     }
 
     phase1res->blockify();
     tableCatalogue.insertTable(phase1res);
+    // the merge passes read the runs, which are laid out like phase1res
+    uint blockCount = phase1res->blockCount;
+    vector<uint> rowsPerBlockCount = phase1res->rowsPerBlockCount;
 
 
 
@@ -920,6 +1610,9 @@ int Table::sortNoIndex(string columnName,string finName, bool toInsert , int buf
     while (1)
     {
         Table* resultantTable = new Table(writeTable, this->columns); 
+        // sorted in place, the last pass writes the pages of the table
+        if (finName == this->tableName)
+            resultantTable->pageLayout = this->pageLayout;
         int tillPage = 0;
         // covers one iteration over the entire table of merging the chunks of chunksize 
         while (1)
@@ -929,8 +1622,8 @@ int Table::sortNoIndex(string columnName,string finName, bool toInsert , int buf
             vector <int> pagePointer; 
 
             for (int i=0; i<(m-1) ;i++){
-                if (i*chunkSize < this->blockCount-tillPage){
-                    cout << "getting page " << chunkSize*i <<  " Block count:" << this->blockCount << " tillPage:"<< tillPage << " i:" << i <<  endl;
+                if (i*chunkSize < blockCount-tillPage){
+                    cout << "getting page " << chunkSize*i <<  " Block count:" << blockCount << " tillPage:"<< tillPage << " i:" << i <<  endl;
                     // pageArr.insert(pageArr.begin()+i,bufferManager.getPage(this->tableName,tillPage+chunkSize*i));
                     pageArr.insert(pageArr.begin()+i,bufferManager.getPage(readTable,tillPage+chunkSize*i));
                 
@@ -947,8 +1640,8 @@ int Table::sortNoIndex(string columnName,string finName, bool toInsert , int buf
             // cout << "got all pages\n";
             int rowsmerged =0;
             int sumrows = 0;
-            for (int i=0; i< chunkSize*(m-1) and i < this->blockCount-tillPage ;i++){
-                sumrows += this->rowsPerBlockCount[tillPage + i];
+            for (int i=0; i< chunkSize*(m-1) and i < blockCount-tillPage ;i++){
+                sumrows += rowsPerBlockCount[tillPage + i];
             }
 
             // merges the m-1 chunks of given chunksize 
@@ -956,7 +1649,7 @@ int Table::sortNoIndex(string columnName,string finName, bool toInsert , int buf
                 int minRow = INT_MAX;
                 int minRowInd = -1;
                 vector <int> minResRow;
-                for  (int i=0;i<m-1 and i < this->blockCount-tillPage ;i++){
+                for  (int i=0;i<m-1 and i < blockCount-tillPage ;i++){
                     if (pageCount[i]>=chunkSize){
                         // cout << " I CONTINUED for " << i << endl;
                         continue;
@@ -985,11 +1678,11 @@ int Table::sortNoIndex(string columnName,string finName, bool toInsert , int buf
 
                 //TODO Fix it - like which page to take next (chunkSize+minRowInd-1) not right 
                 // Done 
-                if (pagePointer[minRowInd] >= this->rowsPerBlockCount[tillPage +pageCount[minRowInd]+ minRowInd*chunkSize] ){
+                if (pagePointer[minRowInd] >= rowsPerBlockCount[tillPage +pageCount[minRowInd]+ minRowInd*chunkSize] ){
                     pageCount[minRowInd]++;
                     pagePointer[minRowInd]=0;
                     if (pageCount[minRowInd]<chunkSize ){
-                        if (tillPage + chunkSize*minRowInd+pageCount[minRowInd]<this->blockCount){
+                        if (tillPage + chunkSize*minRowInd+pageCount[minRowInd]<blockCount){
                             // pageArr.insert(pageArr.begin()+minRowInd,bufferManager.getPage(readTable,tillPage + chunkSize*minRowInd+pageCount[minRowInd]));
                             pageArr[minRowInd]=bufferManager.getPage(readTable,tillPage + chunkSize*minRowInd+pageCount[minRowInd]);
                         }
@@ -1012,7 +1705,7 @@ int Table::sortNoIndex(string columnName,string finName, bool toInsert , int buf
             //     jpo++;
             // }
 
-            if (tillPage >= this->blockCount)
+            if (tillPage >= blockCount)
                 break;
         }
 
@@ -1025,7 +1718,7 @@ int Table::sortNoIndex(string columnName,string finName, bool toInsert , int buf
             readTable = "_X"+this->tableName;
             // cout << "seg fault ?\n";
 
-            if (chunkSize<this->blockCount || (1)){
+            if (chunkSize<blockCount || (1)){
                 tableCatalogue.deleteTable("_Y"+this->tableName);
             }
 
@@ -1036,7 +1729,7 @@ int Table::sortNoIndex(string columnName,string finName, bool toInsert , int buf
         else {
             readTable = "_Y"+this->tableName;
 
-            if (chunkSize<this->blockCount || (1)){
+            if (chunkSize<blockCount || (1)){
                 tableCatalogue.deleteTable("_X"+this->tableName);
             }
             
@@ -1044,7 +1737,7 @@ int Table::sortNoIndex(string columnName,string finName, bool toInsert , int buf
         }
 
 
-        if (chunkSize>=this->blockCount){
+        if (chunkSize>=blockCount){
             // cout << "output in " << readTable << endl;
             
             //RENAMING OUTPUT
@@ -1065,131 +1758,58 @@ int Table::sortNoIndex(string columnName,string finName, bool toInsert , int buf
                 resultantTable->sourceFileName = "../data/"+finName+".csv";
                 if (toInsert)
                     tableCatalogue.insertTable(resultantTable);
+                // sorted in place, the pages now follow the new layout
+                if (finName == this->tableName)
+                {
+                    this->blockCount = resultantTable->blockCount;
+                    this->rowsPerBlockCount = resultantTable->rowsPerBlockCount;
+                    this->minValuesPerBlock = resultantTable->minValuesPerBlock;
+                    this->maxValuesPerBlock = resultantTable->maxValuesPerBlock;
+                    // every row is written whole now, in pages sized for it
+                    this->maxRowsPerBlock = resultantTable->maxRowsPerBlock;
+                    this->lazyColumnDefaults.clear();
+                }
             }
 
             break;
         }
 
         else {
-            if(resultantTable->blockify()){
-            if (toInsert)
+            // intermediate runs are read back by the next pass, register them
+            // even when the final result is not inserted
+            if(resultantTable->blockify())
                 tableCatalogue.insertTable(resultantTable);
-            }
         }
     }
     
 }
 
 /**
- * @brief Function that add the index of column indicated by indexName
- * 
+ * @brief Function that adds a column to the table without touching its pages.
+ * The column and its default are only recorded; a row written before reads
+ * the default when its page is read, and has the column once the page is
+ * written again. The column is the last one, so no index changes, and the
+ * pages keep the number of rows they hold.
+ *
  * @param  columnName
- * @return int 
+ * @param  defaultValue value of the column in the rows already in the table
+ * @return int
  */
-int Table::addCol(string columnName){
-    cout << "begin operation alter"<< endl;
-    cout << columnName << " is to be added "<< endl;
-    // for (auto d:this->columns){
-    //     cout << d << " ";
-    // }
-
-    vector <string> newCol = this->columns;
-    newCol.emplace_back(columnName);
-    Table * resultantTable = new Table("A_temp"+this->tableName, newCol); 
-    
-    // cout << endl;
-    // cout << "DIS VAL PUSH"<< endl;
-    int blkiter=0;
-    bool flag = 0;    
-    // cout << "meta data altered"<< endl;
-    for (auto d : this->rowsPerBlockCount)
+int Table::addCol(string columnName, int defaultValue){
+    logger.log("Table::addCol");
+    this->columns.emplace_back(columnName);
+    this->columnCount++;
+    this->lazyColumnDefaults.push_back(defaultValue);
+    this->distinctValuesInColumns.push_back({defaultValue});
+    this->distinctValuesPerColumnCount.push_back(1);
+    for (int pageCounter = 0; pageCounter < this->minValuesPerBlock.size(); pageCounter++)
     {
-        // cout << d << " PRINT D VALUE " << endl;
-
-        flag = 1;
-        Page lastPage = bufferManager.getPage(this->tableName, blkiter);
-        vector<vector<int>> rowset1 = lastPage.getRows();
-        vector<vector<int>> rowset;
-
-        for (int i =0; i < d;i++){
-            rowset.push_back(rowset1[i]);
-            rowset[i].push_back(0);
-            // for (auto lol : rowset[i]){
-            //     cout << lol << " ";
-            // }
-            // cout << "updates << " << endl;
-        }
-
-        // for (auto rt : rowset){
-        //     for (auto lol : rt){
-        //         cout << lol << " ";
-        //     }
-        //     cout << endl;
-        // }
-
-        resultantTable->writeRows(rowset);
-        
-        // lastPage.writeToPage(rowset);
-        // bufferManager.updatePage(this->tableName + "_Page" + to_string(blkiter), lastPage);
-
-        blkiter++;
-    }
-    
-    // resultantTable->tableName=this->tableName;
-    resultantTable->blockify();
-
-    string nameOG = this->tableName;
-    tableCatalogue.deleteTable(this->tableName);
-
-    // resultantTable->tableName= this->tableName ; 
-    // /*
-    blkiter=0;
-    for (auto d : resultantTable->rowsPerBlockCount){
-
-        // Page newPage = bufferManager.getPage(resultantTable->tableName,blkiter);
-        // cout << "segway\n";
-        // cout << "PAGE ROWS : "  << newPage.getRowCount()  << endl;
-        // cout << "PAGE ROWS : "  << d  << endl;
-
-
-        string ktemp = "../data/temp/"+resultantTable->tableName+"_Page"+to_string(blkiter);
-        char oldname[ktemp.length()+1] ;
-        strcpy(oldname, ktemp.c_str());
-
-        ktemp = "../data/temp/"+nameOG+"_Page"+to_string(blkiter); 
-        char newname[ktemp.length()+1];
-        strcpy(newname, ktemp.c_str());
-
-        rename(oldname,newname);    
-
-        bufferManager.unloadPage("../data/temp/"+nameOG+"_Page"+to_string(blkiter));
-
-        // bufferManager.updatePage("../data/temp/"+this->tableName+"_Page"+to_string(blkiter),newPage);
-
-
-        blkiter++;  
+        this->minValuesPerBlock[pageCounter].push_back(defaultValue);
+        this->maxValuesPerBlock[pageCounter].push_back(defaultValue);
     }
-
-
-    resultantTable->tableName=nameOG;
-    tableCatalogue.insertTable(resultantTable);
-    // this->columns.emplace_back(columnName);
-    // Page lkl = bufferManager.getPage(nameOG,18);
-    // vector <vector<int>> polo = lkl.getRows();
-    // for (auto lk : polo){
-    //     for (auto pol : lk){
-    //         cout << pol << " ";
-    //     }
-    //     cout << endl;
-    // } 
-    // cout << "PRINTED LAST PADE \n";
-    // this->columnCount++;
-    // this->distinctValuesPerColumnCount.push_back(1);
-    // this->maxRowsPerBlock
-    // */
-
+    // the pooled pages are read again with the column
+    bufferManager.unloadPages();
     return 0;
-
 }
 
 
@@ -1222,137 +1842,274 @@ pair<int,int> Table::checkSame(vector< vector<int>> rows, int rowsCount, vector<
 }
 
 
-int Table::deleteRow(vector <int> values){
-    int found = 0;
-    if(this->indexed){
-        // it is indexed
-        if(this->indexingStrategy == BTREE){
-            // BTREE
-            pair<int,int> p = this->BplusTree.search(values[this->indexedColumnNumber]);
-            if(p.first == -1){
-                // not in Table, check in Overflow block
-                Page page = bufferManager.getPage(this->tableName,-1);
-                vector < vector< int> > rows = page.getRows();
-                int found = 1;
-                for (int i = 0; !found && i < page.getRowCount(); i++)
-                {
-                    found = 1;
-                    for (int j = 0; j < this->columnCount; j++)
-                    {
-                        if(values[j] != rows[i][j]){
-                            found = 0;
-                        }
-                    }
-                    if(found){
-                        // Page page = bufferManager.getPage(this->tableName,pageNum);
-                        // vector < vector<int> > rows = page.getRows();
-                        rows.erase(rows.begin() + i);
-                        page.writeRows(rows,page.getRowCount() - 1);
-                        page.writePage();
-                        bufferManager.updatePage(this->tableName + "_Page" + to_string(-1),page);                       
-                    }                    
-                }
+/**
+ * @brief Function that finds a row of the table equal to values. The
+ * candidates come from the primary index, or else from a secondary index, and
+ * only the pages they are in are read. The rows of the delta store with the
+ * same key are checked last.
+ *
+ * @param values
+ * @return pagePtr, rowPtr of the row, {-1, -1} if there is none
+ */
+pair<int,int> Table::findRow(vector<int> values)
+{
+    logger.log("Table::findRow");
+    vector<pair<int,int>> candidates;
+    bool located = true;
+    if (this->indexed)
+    {
+        int key = values[this->indexedColumnNumber];
+        if (this->indexingStrategy == BTREE)
+            candidates = this->BplusTree.searchRange(key, key);
+        else
+            candidates = this->Hashing.searchElement(key);
+    }
+    else if (!this->secondaryIndexes.empty())
+    {
+        SecondaryIndex &secondaryIndex = this->secondaryIndexes[0];
+        int key = values[secondaryIndex.columnIndex];
+        if (secondaryIndex.indexingStrategy == BTREE)
+            candidates = secondaryIndex.BplusTree.searchRange(key, key);
+        else if (secondaryIndex.indexingStrategy == HASH)
+            candidates = secondaryIndex.Hashing.searchElement(key);
+        else if (secondaryIndex.Bitmap.bitmaps.count(key))
+            candidates = secondaryIndex.Bitmap.locate(secondaryIndex.Bitmap.bitmaps[key]);
+    }
+    else
+        located = false;
 
-            }
-            else{
-                // in main block 
-                int curval = values[indexedColumnNumber];
-                int ind = p.first; // get this page
-                int val = curval; // this is cur val of indexed column
-                int startRow = 0; // start from where row is queried
-                int found = 0;
-                while (!found && curval == val && ind < this->blockCount)
-                {
-                    /* code */
-                    found = 1;
-                    Page page = bufferManager.getPage(this->tableName,ind);
-                    vector < vector <int >> rows = page.getRows();
-                    pair<int,int> p = checkSame(rows,this->rowsPerBlockCount[ind],values);   
-                    if(p.first = 1){
-                        // found here
-                        found = 1;
-                        int where = p.second;
-                        rows.erase(rows.begin() + where);
-                        this->rowsPerBlockCount[ind]--;
-                        page.writeRows(rows,page.getRowCount() - 1);
-                        page.writePage();
-                        bufferManager.updatePage(this->tableName + "_Page" + to_string(ind),page);
-                        // now update all trailing elements
-                        for (int i = where; i < rowsPerBlockCount[ind]; i++)
-                        {
-                            this->BplusTree.searchAndUpdate(rows[i][this->indexedColumnNumber],ind,i);
-                        }
-                    }
-                    else{
-                        val = rows[this->rowsPerBlockCount[ind]][this->indexedColumnNumber];
-                        ind++;
-                    }
-                }
-                if(!found){
-                    cout << "NOT FOUND" << endl;
-                }
-            }
+    if (located)
+    {
+        for (auto &location : candidates)
+        {
+            Page page = bufferManager.getPage(this->tableName, location.first);
+            if (page.getRow(location.second) == values)
+                return location;
         }
-        else{
-            // HASH
-            vector< pair<int,int> > p = this->Hashing.searchElement(values[this->indexedColumnNumber]);
-            int found = 0;
-            for (int i = 0; !found && i < p.size(); i++)
-            {
-                found = 1;
-                int pageNum = p[i].first;
-                int rowNum = p[i].second;
-                Page page = bufferManager.getPage(this->tableName,pageNum);
-                vector < vector<int> > rows = page.getRows();
-                
-                for (int i = 0; !found && i < this->columnCount; i++)
-                {
-                    if(rows[rowNum][i] != values[i]){
-                        // this is the row to be deleted
-                        found = 0;
-                    }
-                }
-                if(found){
-                    // delete this
-                    Page page = bufferManager.getPage(this->tableName,pageNum);
-                    vector < vector<int> > rows = page.getRows();
-                    rows.erase(rows.begin() + rowNum);
-                    page.writeRows(rows,page.getRowCount() - 1);
-                    page.writePage();
-                    bufferManager.updatePage(this->tableName + "_Page" + to_string(pageNum),page);
-                }
-            }
+    }
+    else
+    {
+        for (int pageCounter = 0; pageCounter < this->blockCount; pageCounter++)
+        {
+            Page page = bufferManager.getPage(this->tableName, pageCounter);
+            vector<vector<int>> rows = page.getRows();
+            for (int rowCounter = 0; rowCounter < this->rowsPerBlockCount[pageCounter]; rowCounter++)
+                if (rows[rowCounter] == values && !this->isDeleted(pageCounter, rowCounter))
+                    return {pageCounter, rowCounter};
         }
     }
-    else{
-        // not indexed
-        // just delete from the page where it belonged to
-        for (int i = 0; i < this->blockCount && !found; i++)
+
+    // rows inserted since the last merge are in no primary index yet
+    if (this->indexed && this->indexingStrategy == BTREE)
+    {
+        vector<pair<int,int>> deltaLocations;
+        vector<vector<int>> deltaRows;
+        int key = values[this->indexedColumnNumber];
+        this->searchDelta(key, key, deltaLocations, deltaRows);
+        for (int rowCounter = 0; rowCounter < deltaRows.size(); rowCounter++)
+            if (deltaRows[rowCounter] == values)
+                return deltaLocations[rowCounter];
+    }
+    return {-1, -1};
+}
+
+/**
+ * @brief Function that deletes a row equal to values
+ *
+ * @param values
+ * @return 1 if a row was deleted, 0 if there is no such row
+ */
+int Table::deleteRow(vector <int> values){
+    logger.log("Table::deleteRow");
+    pair<int,int> location = this->findRow(values);
+    if (location.second < 0)
+        return 0;
+    map<int, vector<int>> deleteSets;
+    deleteSets[location.first].push_back(location.second);
+    return this->deleteRows(deleteSets);
+}
+
+/**
+ * @brief Function that deletes the rows in the given slots, page by page. A
+ * row is only marked deleted in its page and its own index entries are
+ * removed; the other rows keep their slots, so no other index entry changes
+ * and the page is not written. A page is compacted, its one write, once
+ * COMPACTION_THRESHOLD of its rows are deleted. The rows of the delta store
+ * are erased from their page right away, with one write of the page, which
+ * keeps the order of the rows of a run.
+ *
+ * @param deleteSets the slots to delete in every page, in increasing order
+ * @return number of rows deleted
+ */
+int Table::deleteRows(map<int, vector<int>> &deleteSets)
+{
+    logger.log("Table::deleteRows");
+    int deletedCount = 0;
+    for (auto &deleteSet : deleteSets)
+    {
+        int pageIndex = deleteSet.first;
+        Page page = bufferManager.getPage(this->tableName, pageIndex);
+        vector<vector<int>> rows = page.getRows();
+        if (pageIndex < 0)
         {
-            Page page = bufferManager.getPage(this->tableName,i);
-            // cout << i << "`LALAL" << endl;
-            vector < vector<int> > rows = page.getRows();
-            for (int j = 0; j < this->rowsPerBlockCount[i] && !found; j++)
+            uint pageRowCount = this->getPageRowCount(pageIndex);
+            vector<vector<int>> liveRows;
+            vector<pair<int,int>> moves;
+            auto slot = deleteSet.second.begin();
+            for (int rowCounter = 0; rowCounter < pageRowCount; rowCounter++)
             {
-                /* code */
-                found = 1;
-                for (int k = 0; k < this->columnCount; k++)
+                if (slot != deleteSet.second.end() && *slot == rowCounter)
                 {
-                    if(rows[j][k] != values[k]){
-                        found = 0;
-                    }
-                }
-                if(found){
-                    this->rowsPerBlockCount[i]--;
-                    rows.erase(rows.begin() + j);
-                    page.writeRows(rows,this->rowsPerBlockCount[i] - 1);
-                    page.writePage();
-                    bufferManager.updatePage(this->tableName + "_Page" + to_string(i),page);
+                    this->unindexSecondaryRow(rows[rowCounter], pageIndex, rowCounter);
+                    slot++;
+                    continue;
                 }
+                if (rowCounter != liveRows.size())
+                    moves.push_back({rowCounter, (int)liveRows.size()});
+                liveRows.push_back(rows[rowCounter]);
+            }
+            uint liveRowCount = liveRows.size();
+            deletedCount += pageRowCount - liveRowCount;
+            this->rowCount -= pageRowCount - liveRowCount;
+            if (pageIndex == -1)
+                this->overflowRowCount = liveRowCount;
+            else
+            {
+                this->deltaRowCount -= pageRowCount - liveRowCount;
+                this->deltaRowsPerBlockCount[pageIndex] = liveRowCount;
             }
+            liveRows.resize(this->maxRowsPerBlock, vector<int>(this->columnCount, 0));
+            page.writeRows(liveRows, liveRowCount);
+            bufferManager.updatePage(this->tableName + "_Page" + to_string(pageIndex), page, true);
+            for (auto &move : moves)
+                this->relocateSecondaryRow(liveRows[move.second], pageIndex, move.first, move.second);
+            continue;
         }
+        for (int rowIndex : deleteSet.second)
+        {
+            if (this->isDeleted(pageIndex, rowIndex))
+                continue;
+            vector<int> &row = rows[rowIndex];
+            this->markDeleted(pageIndex, rowIndex);
+            if (this->indexed && this->indexingStrategy == BTREE)
+                this->BplusTree.removeKey(row[this->indexedColumnNumber], pageIndex, rowIndex);
+            else if (this->indexed)
+                this->Hashing.deleteItem(row[this->indexedColumnNumber], pageIndex, rowIndex);
+            this->unindexSecondaryRow(row, pageIndex, rowIndex);
+            this->rowCount--;
+            deletedCount++;
+        }
+        if (this->deletedRowsPerBlockCount[pageIndex] > COMPACTION_THRESHOLD * this->rowsPerBlockCount[pageIndex])
+            this->compactPage(pageIndex);
+    }
+    return deletedCount;
+}
+
+/**
+ * @brief Function that tells whether the row in a slot has been deleted
+ *
+ * @param pageIndex
+ * @param rowIndex
+ * @return true if the slot holds a deleted row
+ */
+bool Table::isDeleted(int pageIndex, int rowIndex)
+{
+    if (pageIndex < 0 || pageIndex >= this->deletedRowsPerBlock.size() || this->deletedRowsPerBlock[pageIndex].empty())
+        return false;
+    return this->deletedRowsPerBlock[pageIndex][rowIndex >> 6] >> (rowIndex & 63) & 1;
+}
+
+/**
+ * @brief Function that marks the row in a slot deleted. The row stays in the
+ * page until the page is compacted.
+ *
+ * @param pageIndex
+ * @param rowIndex
+ */
+void Table::markDeleted(int pageIndex, int rowIndex)
+{
+    if (this->deletedRowsPerBlock.size() < this->blockCount)
+    {
+        this->deletedRowsPerBlock.resize(this->blockCount);
+        this->deletedRowsPerBlockCount.resize(this->blockCount, 0);
+    }
+    vector<uint64_t> &deletedRows = this->deletedRowsPerBlock[pageIndex];
+    if (deletedRows.empty())
+        deletedRows.assign((this->maxRowsPerBlock + 63) / 64, 0);
+    deletedRows[rowIndex >> 6] |= 1ULL << (rowIndex & 63);
+    this->deletedRowsPerBlockCount[pageIndex]++;
+}
+
+/**
+ * @brief Function that rewrites a page without its deleted rows. The rows
+ * after a deleted one move up, and the index entries of every row that moved
+ * are pointed at its new slot. The order of the rows is kept, so a table
+ * clustered on its B+tree stays clustered.
+ *
+ * @param pageIndex
+ */
+void Table::compactPage(int pageIndex)
+{
+    logger.log("Table::compactPage");
+    Page page = bufferManager.getPage(this->tableName, pageIndex);
+    vector<vector<int>> rows = page.getRows();
+    vector<vector<int>> liveRows;
+    vector<pair<int,int>> moves;
+    for (int rowCounter = 0; rowCounter < this->rowsPerBlockCount[pageIndex]; rowCounter++)
+    {
+        if (this->isDeleted(pageIndex, rowCounter))
+            continue;
+        if (rowCounter != liveRows.size())
+            moves.push_back({rowCounter, (int)liveRows.size()});
+        liveRows.push_back(rows[rowCounter]);
+    }
+    int liveRowCount = liveRows.size();
+    liveRows.resize(this->maxRowsPerBlock, vector<int>(this->columnCount, 0));
+    page.writeRows(liveRows, liveRowCount);
+    bufferManager.updatePage(this->tableName + "_Page" + to_string(pageIndex), page, true);
+    this->rowsPerBlockCount[pageIndex] = liveRowCount;
+    vector<uint64_t>().swap(this->deletedRowsPerBlock[pageIndex]);
+    this->deletedRowsPerBlockCount[pageIndex] = 0;
+    this->freeSpacePages.insert(pageIndex);
+    for (auto &move : moves)
+        this->relocateRow(liveRows[move.second], pageIndex, move.first, move.second);
+}
+
+/**
+ * @brief Function that merges the delta store into the pages and compacts
+ * every page with deleted rows. Called before the pages are reorganised as a
+ * whole, which then see every row and never a deleted one.
+ */
+void Table::compactAll()
+{
+    logger.log("Table::compactAll");
+    this->mergeDelta();
+    for (int pageCounter = 0; pageCounter < this->deletedRowsPerBlockCount.size(); pageCounter++)
+        if (this->deletedRowsPerBlockCount[pageCounter])
+            this->compactPage(pageCounter);
+    // the pages are read back from their files by what follows
+    bufferManager.flushPages();
+}
+
+/**
+ * @brief Function that points the entries of a row in every index at the slot
+ * of its page it moved to
+ *
+ * @param row
+ * @param pageIndex
+ * @param fromRow
+ * @param toRow
+ */
+void Table::relocateRow(vector<int> row, int pageIndex, int fromRow, int toRow)
+{
+    if (this->indexed && this->indexingStrategy == BTREE)
+        this->BplusTree.relocate(row[this->indexedColumnNumber], pageIndex, fromRow, toRow);
+    else if (this->indexed)
+    {
+        this->Hashing.deleteItem(row[this->indexedColumnNumber], pageIndex, fromRow);
+        this->Hashing.insertItem(row[this->indexedColumnNumber], pageIndex, toRow);
     }
-    return found;
+    this->relocateSecondaryRow(row, pageIndex, fromRow, toRow);
 }
 
 /**
@@ -1362,6 +2119,7 @@ int Table::deleteRow(vector <int> values){
  * @return int 
  */
 int Table::deleteCol(string columnName){
+    this->compactAll();
     // cout << "begin operation alter"<< endl;
     // cout << columnName << " is to be deleted "<< endl;
     // for (auto d:this->columns){
@@ -1372,6 +2130,7 @@ int Table::deleteCol(string columnName){
     vector <string> newCol = this->columns;
     newCol.erase(newCol.begin()+colind);
     Table * resultantTable = new Table("A_temp"+this->tableName, newCol); 
+    resultantTable->pageLayout = this->pageLayout;
     
     // cout << endl;
     // cout << "DIS VAL PUSH"<< endl;
@@ -1404,7 +2163,8 @@ int Table::deleteCol(string columnName){
         //     cout << endl;
         // }
 
-        resultantTable->writeRows(rowset);
+        if (!rowset.empty())
+            resultantTable->writeRows(rowset);
         
         // lastPage.writeToPage(rowset);
         // bufferManager.updatePage(this->tableName + "_Page" + to_string(blkiter), lastPage);
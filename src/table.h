@@ -1,14 +1,53 @@
 #include "cursor.h"
 #include "bplustree.h"
 #include "hashing.h"
+#include "bitmap.h"
 
 enum IndexingStrategy
 {
     BTREE,
     HASH,
+    BITMAP,
     NOTHING
 };
 
+/**
+ * @brief A secondary index of a table. Unlike the primary index of the table
+ * (indexedColumn), building one never reorders the pages; it maps the values
+ * of its column to the locations of the rows holding them. A table can have
+ * any number of them, at most one per column. BITMAP indexes are only ever
+ * secondary.
+ *
+ */
+struct SecondaryIndex
+{
+    string column = "";
+    uint columnIndex = 0;
+    IndexingStrategy indexingStrategy = NOTHING;
+    string thirdParam = "";
+    bplusTree BplusTree;
+    hashing Hashing;
+    bitmapIndex Bitmap;
+};
+
+/**
+ * @brief A sorted run of the delta store of a table clustered on its B+tree.
+ * Its pages are numbered -2, -3, ... and hold rows in key order across the
+ * run. A run of level 0 is a full overflow page, one of level l the merge of
+ * DELTA_RUNS_PER_LEVEL runs of level l - 1, a BULK_INSERT batch a run of the
+ * level of its size.
+ *
+ */
+struct DeltaRun
+{
+    vector<int> pages;
+    uint level = 0;
+    int minKey = 0;
+    int maxKey = 0;
+    // key of the first row of every page, as written
+    vector<int> firstKeys;
+};
+
 /**
  * @brief The Table class holds all information related to a loaded table. It
  * also implements methods that interact with the parsers, executors, cursors
@@ -34,15 +73,35 @@ public:
     uint blockCount = 0;
     uint maxRowsPerBlock = 0;
     vector<uint> rowsPerBlockCount;
+    // rows deleted but still in their page, a bitset per page
+    vector<vector<uint64_t>> deletedRowsPerBlock;
+    vector<uint> deletedRowsPerBlockCount;
+    // pages before the tail page that compaction left room in
+    set<uint> freeSpacePages;
+    uint overflowRowCount = 0;
+    // the rows inserted into a BTREE clustered table since its pages were
+    // last merged with them, beyond the overflow page
+    vector<DeltaRun> deltaRuns;
+    map<int, uint> deltaRowsPerBlockCount;
+    uint deltaRowCount = 0;
+    // defaults of the last columns, added by ALTER without rewriting the
+    // pages. A row written before them ends short and reads them from here
+    vector<int> lazyColumnDefaults;
+    // chosen at LOAD, the layout the pages are written in
+    PageLayout pageLayout = ROW_MAJOR;
+    vector<vector<int>> minValuesPerBlock;
+    vector<vector<int>> maxValuesPerBlock;
     bool indexed = false;
     string indexedColumn = "";
     IndexingStrategy indexingStrategy = NOTHING;
     bplusTree BplusTree;
     hashing Hashing;
+    vector<SecondaryIndex> secondaryIndexes;
     
     bool extractColumnNames(string firstLine);
     bool blockify();
     void updateStatistics(vector<int> row);
+    void updateZoneMap(int pageIndex, vector<int> row);
     Table();
     Table(string tableName);
     Table(string tableName, vector<string> columns);
@@ -52,21 +111,47 @@ public:
     void print();
     pair<int,int> insertLast( vector<int> values);
     int insertRow( vector<int> values);
+    int insertRows(vector<vector<int>> &rows);
+    uint getPageRowCount(int pageIndex);
+    vector<int> getDeltaPages();
+    void searchDelta(int low, int high, vector<pair<int,int>> &locations, vector<vector<int>> &rows);
+    void flushOverflowPage();
+    void addDeltaRun(vector<vector<int>> &rows, vector<pair<int,int>> &locations, uint level);
+    void mergeDeltaRuns();
+    bool deltaFull();
+    void mergeDelta();
     int sortNoIndex( string columnName,string finName, bool toInsert =1, int buffersizeM = 3 );
     int sortDesc( string columnName,string finName, bool toInsert =1, int buffersizeM = 10 );
-    int addCol( string columnName);
+    int addCol( string columnName, int defaultValue);
     int deleteCol( string columnName);
     int deleteRow(vector <int> values);
+    int deleteRows(map<int, vector<int>> &deleteSets);
+    pair<int,int> findRow(vector<int> values);
+    bool isDeleted(int pageIndex, int rowIndex);
+    void markDeleted(int pageIndex, int rowIndex);
+    void compactPage(int pageIndex);
+    void compactAll();
+    void relocateRow(vector<int> row, int pageIndex, int fromRow, int toRow);
     void makePermanent();
     void writeRows(vector <vector<int>> rowsArr);
     bool isPermanent();
     pair<int,int> checkSame(vector< vector<int>> rows, int rowsCount, vector<int> values);
     void getNextPage(Cursor *cursor);
-    Cursor getCursor();
+    Cursor getCursor(vector<int> columnIndices = {});
     int getColumnIndex(string columnName);
     void unload();
     int checkIndex();
     int indexTable(string columnName,IndexingStrategy indexingStrategy, string thirdParam);
+    SecondaryIndex *getSecondaryIndex(string columnName);
+    bool indexKeys(string columnName, int low, int high, vector<int> &keys);
+    void addSecondaryIndex(string columnName, IndexingStrategy indexingStrategy, string thirdParam);
+    void buildSecondaryIndex(SecondaryIndex &secondaryIndex);
+    void loadSecondaryIndex(SecondaryIndex &secondaryIndex, vector<tuple<int, int, int>> &entries);
+    void rebuildSecondaryIndexes();
+    void indexSecondaryRow(vector<int> row, int pageIndex, int rowIndex);
+    void indexSecondaryRows(vector<vector<int>> &rows, vector<pair<int,int>> &locations);
+    void unindexSecondaryRow(vector<int> row, int pageIndex, int rowIndex);
+    void relocateSecondaryRow(vector<int> row, int pageIndex, int fromRow, int toRow);
 
     /**
  * @brief Static function that takes a vector of valued and prints them out in a
@@ -8,16 +8,43 @@ void TableCatalogue::insertTable(Table* table)
 void TableCatalogue::deleteTable(string tableName)
 {
     logger.log("TableCatalogue::deleteTable"); 
+    this->waitForMerge();
     this->tables[tableName]->unload();
     delete this->tables[tableName];
     this->tables.erase(tableName);
 }
 
+/**
+ * @brief Starts merging the delta store of a table into its pages on the
+ * merger thread. Called as the last step of a command, so the merge runs while
+ * the next command is read.
+ *
+ * @param table
+ */
+void TableCatalogue::mergeInBackground(Table* table)
+{
+    logger.log("TableCatalogue::mergeInBackground");
+    this->waitForMerge();
+    this->merger = thread(&Table::mergeDelta, table);
+}
+
+/**
+ * @brief Waits for the merge started by mergeInBackground, if any. Every
+ * command waits before it is parsed, and no table is touched meanwhile.
+ */
+void TableCatalogue::waitForMerge()
+{
+    if (this->merger.joinable())
+        this->merger.join();
+}
+
 Table* TableCatalogue::getTable(string tableName)
 {
     logger.log("TableCatalogue::getTable"); 
-    Table *table = this->tables[tableName];
-    return table;
+    auto table = this->tables.find(tableName);
+    if (table == this->tables.end())
+        return NULL;
+    return table->second;
 }
 bool TableCatalogue::isTable(string tableName)
 {
@@ -33,10 +60,6 @@ bool TableCatalogue::isColumnFromTable(string columnName, string tableName)
     if (this->isTable(tableName))
     {
         Table* table = this->getTable(tableName);
-        for (int i = 0; i < 2; i++)
-        {
-            cout << table->columns[i];
-        }
         if (table->isColumn(columnName))
             {
                 return true;
@@ -61,6 +84,7 @@ void TableCatalogue::print()
 
 TableCatalogue::~TableCatalogue(){
     logger.log("TableCatalogue::~TableCatalogue"); 
+    this->waitForMerge();
     for(auto table: this->tables){
         table.second->unload();
         delete table.second;
@@ -10,11 +10,15 @@ class TableCatalogue
 {
 
     unordered_map<string, Table*> tables;
+    // merges the delta store of a table into its pages between two commands
+    thread merger;
 
 public:
     TableCatalogue() {}
     void insertTable(Table* table);
     void deleteTable(string tableName);
+    void mergeInBackground(Table* table);
+    void waitForMerge();
     Table* getTable(string tableName);
     bool isTable(string tableName);
     bool isColumnFromTable(string columnName, string tableName);
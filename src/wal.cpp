@@ -0,0 +1,333 @@
+#include "global.h"
+#include <fcntl.h>
+#include <unistd.h>
+
+// plain arrays, the log is opened by a global constructed in another file
+const char LOG_FILE_NAME[] = "../data/wal";
+const char CHECKPOINT_RECORD[] = "CHECKPOINT";
+
+/**
+ * @brief CRC32 (the polynomial of zlib) of a record, as 8 hex digits
+ *
+ * @param record
+ * @return string
+ */
+static string checksum(const string &record)
+{
+    static uint32_t table[256];
+    static bool tableBuilt = false;
+    if (!tableBuilt)
+    {
+        for (uint32_t byte = 0; byte < 256; byte++)
+        {
+            uint32_t crc = byte;
+            for (int bit = 0; bit < 8; bit++)
+                crc = crc & 1 ? 0xEDB88320 ^ (crc >> 1) : crc >> 1;
+            table[byte] = crc;
+        }
+        tableBuilt = true;
+    }
+    uint32_t crc = 0xFFFFFFFF;
+    for (unsigned char character : record)
+        crc = table[(crc ^ character) & 0xFF] ^ (crc >> 8);
+    char digits[9];
+    snprintf(digits, sizeof(digits), "%08x", crc ^ 0xFFFFFFFF);
+    return digits;
+}
+
+/**
+ * @brief Reads the records of the log, up to the first one that is torn or
+ * does not match its checksum
+ *
+ * @param torn out, true if the log does not end with a whole valid record
+ * @return vector<string>
+ */
+static vector<string> readRecords(bool &torn)
+{
+    vector<string> records;
+    ifstream fin(LOG_FILE_NAME, ios::in);
+    string line;
+    torn = false;
+    while (getline(fin, line))
+    {
+        // a line cut short has no newline
+        if (fin.eof() || line.size() < 10 || line[8] != ' ' || line.compare(0, 8, checksum(line.substr(9))) != 0)
+        {
+            torn = true;
+            break;
+        }
+        records.push_back(line.substr(9));
+    }
+    return records;
+}
+
+/**
+ * @brief Splits a record into the table it is logged for and its statement
+ */
+static void splitRecord(const string &record, string &tableName, string &statement)
+{
+    size_t space = record.find(' ');
+    tableName = record.substr(0, space);
+    statement = space == string::npos ? "" : record.substr(space + 1);
+}
+
+/**
+ * @brief fsyncs a file, or a directory so that a rename in it is durable
+ *
+ * @param fileName
+ */
+static void syncFile(string fileName)
+{
+    int file = open(fileName.c_str(), O_RDONLY);
+    if (file < 0)
+    {
+        logger.log("WriteAheadLog::syncFile: Err");
+        return;
+    }
+    fsync(file);
+    close(file);
+}
+
+/**
+ * @brief Writes all of buffer to a file, however many write calls it takes
+ */
+static bool writeAll(int file, const string &buffer)
+{
+    size_t written = 0;
+    while (written < buffer.size())
+    {
+        ssize_t count = write(file, buffer.data() + written, buffer.size() - written);
+        if (count < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        written += count;
+    }
+    return true;
+}
+
+WriteAheadLog::WriteAheadLog()
+{
+    logger.log("WriteAheadLog::WriteAheadLog");
+    this->recoverLog();
+    this->logFile = open(LOG_FILE_NAME, O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (this->logFile < 0)
+        logger.log("WriteAheadLog::WriteAheadLog: Err");
+    this->writer = thread(&WriteAheadLog::writeInBackground, this);
+}
+
+WriteAheadLog::~WriteAheadLog()
+{
+    {
+        lock_guard<mutex> lock(this->logMutex);
+        this->stopping = true;
+    }
+    this->writeSignal.notify_one();
+    this->writer.join();
+    if (this->logFile >= 0)
+        close(this->logFile);
+}
+
+/**
+ * @brief Called at startup, before the log is opened for appending. Cuts off
+ * a torn tail, completes an export whose checkpoint was logged but whose csv
+ * was not renamed into place, and drops the records every table has
+ * checkpointed since they were logged.
+ */
+void WriteAheadLog::recoverLog()
+{
+    logger.log("WriteAheadLog::recoverLog");
+    bool torn;
+    vector<string> records = readRecords(torn);
+    map<string, int> lastCheckpoint, lastRecord;
+    string tableName, statement;
+    for (int recordCounter = 0; recordCounter < records.size(); recordCounter++)
+    {
+        splitRecord(records[recordCounter], tableName, statement);
+        if (statement == CHECKPOINT_RECORD)
+            lastCheckpoint[tableName] = recordCounter;
+        lastRecord[tableName] = recordCounter;
+    }
+
+    // nothing is logged for a table while it is exported
+    for (auto &record : lastRecord)
+    {
+        string fileName = "../data/" + record.first + ".csv";
+        struct stat buffer;
+        if (stat((fileName + ".tmp").c_str(), &buffer) != 0)
+            continue;
+        if (lastCheckpoint.count(record.first) && lastCheckpoint[record.first] == record.second)
+            rename((fileName + ".tmp").c_str(), fileName.c_str());
+        else
+            remove((fileName + ".tmp").c_str());
+    }
+
+    string compacted;
+    int keptCount = 0;
+    for (int recordCounter = 0; recordCounter < records.size(); recordCounter++)
+    {
+        splitRecord(records[recordCounter], tableName, statement);
+        if (lastCheckpoint.count(tableName) && recordCounter <= lastCheckpoint[tableName])
+            continue;
+        compacted += checksum(records[recordCounter]) + " " + records[recordCounter] + "\n";
+        keptCount++;
+    }
+    if (!torn && keptCount == records.size())
+        return;
+
+    string compactedFileName = string(LOG_FILE_NAME) + ".tmp";
+    int file = open(compactedFileName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (file < 0 || !writeAll(file, compacted) || fsync(file))
+    {
+        logger.log("WriteAheadLog::recoverLog: Err");
+        if (file >= 0)
+            close(file);
+        return;
+    }
+    close(file);
+    rename(compactedFileName.c_str(), LOG_FILE_NAME);
+    syncFile("../data");
+}
+
+/**
+ * @brief Body of the log writer thread. Whatever has been appended when it
+ * wakes is written with one write and made durable with one fsync, the
+ * records appended in the meantime forming the next group.
+ */
+void WriteAheadLog::writeInBackground()
+{
+    unique_lock<mutex> lock(this->logMutex);
+    while (true)
+    {
+        this->writeSignal.wait(lock, [this] { return this->stopping || !this->pending.empty(); });
+        if (this->pending.empty())
+            break;
+        string group;
+        group.swap(this->pending);
+        unsigned long long groupEnd = this->appendedRecords;
+        lock.unlock();
+        if (this->logFile >= 0 && (!writeAll(this->logFile, group) || fsync(this->logFile)))
+            logger.log("WriteAheadLog::writeInBackground: Err");
+        lock.lock();
+        this->durableRecords = groupEnd;
+        this->durableSignal.notify_all();
+    }
+}
+
+/**
+ * @brief Appends a record to the log. It is durable once commit returns.
+ *
+ * @param tableName table the record is replayed on
+ * @param record
+ */
+void WriteAheadLog::append(string tableName, string record)
+{
+    logger.log("WriteAheadLog::append");
+    record = tableName + " " + record;
+    lock_guard<mutex> lock(this->logMutex);
+    this->pending += checksum(record) + " " + record + "\n";
+    this->appendedRecords++;
+    this->writeSignal.notify_one();
+}
+
+/**
+ * @brief Logs the statement being executed, as tokenized, if it changes a
+ * table that has a csv. The changes to other tables are lost at exit anyway.
+ *
+ * @param table
+ */
+void WriteAheadLog::logStatement(Table *table)
+{
+    string statement;
+    for (auto &token : tokenizedQuery)
+        statement += (statement.empty() ? "" : " ") + token;
+    this->logStatement(table, statement);
+}
+
+void WriteAheadLog::logStatement(Table *table, string statement)
+{
+    if (this->replaying || !table->isPermanent())
+        return;
+    this->append(table->tableName, statement);
+}
+
+/**
+ * @brief Waits until every record appended so far is durable
+ */
+void WriteAheadLog::commit()
+{
+    logger.log("WriteAheadLog::commit");
+    unique_lock<mutex> lock(this->logMutex);
+    unsigned long long target = this->appendedRecords;
+    this->durableSignal.wait(lock, [this, target] { return this->durableRecords >= target; });
+}
+
+/**
+ * @brief Puts the csv an export has written aside in place of the old one.
+ * Once the CHECKPOINT record is durable the records logged for the table
+ * before it are never replayed, and the rename is redone at startup if it
+ * does not happen.
+ *
+ * @param tableName
+ * @param fileName the csv written aside
+ * @param newFileName the csv of the table
+ */
+void WriteAheadLog::checkpoint(string tableName, string fileName, string newFileName)
+{
+    logger.log("WriteAheadLog::checkpoint");
+    syncFile(fileName);
+    this->append(tableName, CHECKPOINT_RECORD);
+    this->commit();
+    rename(fileName.c_str(), newFileName.c_str());
+    syncFile("../data");
+}
+
+/**
+ * @brief Runs again the statements logged for a table after its last
+ * checkpoint. Called by LOAD once the table is in the catalogue.
+ *
+ * @param tableName
+ */
+void WriteAheadLog::replay(string tableName)
+{
+    logger.log("WriteAheadLog::replay");
+    this->commit();
+    bool torn;
+    vector<string> records = readRecords(torn);
+    vector<string> statements;
+    string recordTableName, statement;
+    for (auto &record : records)
+    {
+        splitRecord(record, recordTableName, statement);
+        if (recordTableName != tableName)
+            continue;
+        if (statement == CHECKPOINT_RECORD)
+            statements.clear();
+        else
+            statements.push_back(statement);
+    }
+    if (statements.empty())
+        return;
+
+    vector<string> savedTokenizedQuery = tokenizedQuery;
+    ParsedQuery savedParsedQuery = parsedQuery;
+    this->replaying = true;
+    for (auto &statement : statements)
+    {
+        tokenizedQuery.clear();
+        parsedQuery.clear();
+        stringstream tokens(statement);
+        string token;
+        while (tokens >> token)
+            tokenizedQuery.push_back(token);
+        tableCatalogue.waitForMerge();
+        if (syntacticParse() && semanticParse())
+            executeCommand();
+    }
+    tableCatalogue.waitForMerge();
+    this->replaying = false;
+    tokenizedQuery = savedTokenizedQuery;
+    parsedQuery = savedParsedQuery;
+}
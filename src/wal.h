@@ -0,0 +1,57 @@
+#include"executor.h"
+
+/**
+ * @brief The WriteAheadLog makes INSERT, DELETE, BULK_INSERT, ALTER and RENAME
+ * durable. The pages in ../data/temp are rebuilt whenever a table is loaded,
+ * so what survives a crash is the csv of a table in ../data and this log of
+ * the statements run on it since. Every statement on a table that has a csv is
+ * appended to ../data/wal as a record of its own, a line holding the CRC32 of
+ * the record and the record, before the statement runs.
+ *
+ * <p>
+ * The records are written and fsynced by a log writer thread. A statement
+ * waits for its record to be durable before the next command is read, and
+ * every record appended meanwhile is written with the same fsync, so that
+ * the statements of a SOURCE script, or the rows of a BULK_INSERT, share a
+ * single one (group commit).
+ * </p>
+ * <p>
+ * EXPORT checkpoints a table: the new csv is written aside, a CHECKPOINT
+ * record is logged and only then is the csv renamed into place. LOAD replays
+ * the records logged for the table after its last checkpoint over the pages
+ * it has just written. At startup a torn or corrupt tail of the log is cut
+ * off, an export interrupted after its checkpoint is completed, and the log is
+ * compacted to the records that would still be replayed.
+ * </p>
+ */
+class WriteAheadLog{
+
+    int logFile = -1;
+    // records appended and not yet handed to the log writer
+    string pending;
+    unsigned long long appendedRecords = 0;
+    unsigned long long durableRecords = 0;
+    mutex logMutex;
+    condition_variable writeSignal;
+    condition_variable durableSignal;
+    bool stopping = false;
+    thread writer;
+    void recoverLog();
+    void writeInBackground();
+
+    public:
+
+    // set while LOAD replays records, which must not be logged again
+    bool replaying = false;
+    // nesting depth of SOURCE scripts, whose statements commit together
+    uint batchDepth = 0;
+
+    WriteAheadLog();
+    ~WriteAheadLog();
+    void append(string tableName, string record);
+    void logStatement(Table *table);
+    void logStatement(Table *table, string statement);
+    void commit();
+    void checkpoint(string tableName, string fileName, string newFileName);
+    void replay(string tableName);
+};